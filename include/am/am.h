@@ -22,6 +22,9 @@
 #include "spd.h"
 #include "evaluation.h"
 #include "vmm.h"
+#include "fetch_decode.h"
+#include "monitor.h"
+#include "jit.h"
 #include "obj_man.h"
 #include "heap_allocator.h"
 #include "object.h"
@@ -38,18 +41,81 @@ struct DesignationRegister
     const ts::Type* lvalue_type = nullptr;
 };
 
+// monomorphic inline cache of a `dot`/`arrow` instruction, see `Execute::accessMember`
+struct MemberAccessCache
+{
+    const ts::Type* object_type = nullptr; // effective type of the entity whose member is accessed
+    const ts::Type* lvalue_type = nullptr;
+    const ts::Type* member_type = nullptr;
+    const ts::Type* member_lvalue_type = nullptr; // `member_type` with qualifier of `lvalue_type`
+};
+
+// inline cache of a `call` instruction, recording the last callee proved to be compatible with
+//   the type of function pointer, see `Execute::call`
+struct CallSiteCache
+{
+    const ts::Type* pointer_type = nullptr;
+    const spd::Function* callee = nullptr;
+};
+
+// direct-mapped cache of pointer arithmetic on pointers referencing an element of an array object, keyed by
+//   the type of pointer and the type of the array object, see `pointerAdd` in am_eval.cc
+// an entry exists only if the pointer type has been checked to be compatible with the element type
+struct PointerArithmeticCache
+{
+    static constexpr size_t SIZE = 64; // must be power of 2
+
+    struct Entry
+    {
+        const ts::Type* pointer_type = nullptr;
+        const ts::Type* array_type = nullptr; // effective type of the array object
+        uint64_t stride = 0; // size of element
+        uint64_t length = 0;
+    };
+
+    Entry entries[SIZE]{};
+
+    Entry& entry(const ts::Type* pointer_type, const ts::Type* array_type) noexcept
+    {
+        auto hash = (reinterpret_cast<uintptr_t>(pointer_type) >> 4) * 31 + (reinterpret_cast<uintptr_t>(array_type) >> 4);
+        return this->entries[hash & (SIZE - 1)];
+    }
+};
+
+class AbstractMachine;
+
+// cast routines of a type in `spd::Global::types`, chosen once when the machine is loaded so that
+//   `cast` instruction dispatches on the kind of operand only, see `Execute::cast`
+struct CastPlan
+{
+    using Routine = void (*)(AbstractMachine& am, ValueBox& operand, const CastPlan& plan);
+    const ts::Type* type = nullptr; // unqualified type to which cast
+    uint64_t align_mask = 0; // `align - 1` of referenced type if `type` is a pointer to object type, otherwise 0
+    Routine routines[static_cast<ts::kind_t>(ts::Kind::ivd) + 1]{}; // indexed by kind of operand
+};
+
 class AbstractMachine
 {
     OperandStack operand_stack{};
     DesignationRegister dsg_reg{};
     state::Global state;
     ObjectManager object_manager;
+    lib::Array<DecodedInstr> instructions; // indexed by code offset (i.e. `pc - layout::CODE_BASE`)
+    lib::Array<MemberAccessCache> member_access_caches; // indexed by `DecodedInstr::cache_id` of `dot`/`arrow`
+    lib::Array<CallSiteCache> call_site_caches; // indexed by `DecodedInstr::cache_id` of `call`
+    PointerArithmeticCache pointer_arithmetic_cache{};
     VirtualMemory memory;
     std::unique_ptr<HeapAllocator> heap_allocator;
     spd::Global static_info;
+    lib::Array<CastPlan> cast_plans; // indexed by type id, parallel to `static_info.types`
+#ifdef CAMI_AM_JIT
+    JIT jit{};
+#endif
 
     friend class Execute;
 
+    friend class JIT;
+
     friend class FetchDecode;
 
     friend class ObjectManager;
@@ -62,11 +128,15 @@ class AbstractMachine
 
 private:
     explicit AbstractMachine(tr::LinkedMBC& bytecode)
-            : state({bytecode.attribute.entry, 0, 0, TraceContext::dummy}),
+            : state({bytecode.attribute.entry, 0, layout::STACK_BOUNDARY, 0, TraceContext::dummy}),
               object_manager(*this, AbstractMachine::countPermanentObject(bytecode)),
+              instructions(FetchDecode::predecode(bytecode.code)),
+              member_access_caches(AbstractMachine::createMemberAccessCaches(this->instructions)),
+              call_site_caches(AbstractMachine::createCallSiteCaches(this->instructions)),
               memory(std::move(bytecode.code), std::move(bytecode.data), bytecode.string_literal_len, this->object_manager),
               heap_allocator(new ::CAMI_MEMORY_HEAP_ALLOCATOR{this->memory}),
-              static_info(std::move(this->initStaticInfo(bytecode))) {}
+              static_info(std::move(this->initStaticInfo(bytecode))),
+              cast_plans(AbstractMachine::createCastPlans(this->static_info.types)) {}
 
 public:
     explicit AbstractMachine(std::unique_ptr<tr::LinkedMBC> bytecode)
@@ -78,8 +148,56 @@ public:
         halt, abort, exception
     };
     ExitCode run();
-    void execute();
+    // run without superinstructions, counting opcode sequences into `histogram`
+    ExitCode run(OpcodeHistogram& histogram);
+    // run without superinstructions and JIT, measuring each opcode into `profiler`
+    ExitCode run(OpcodeProfiler& profiler);
+    // run without JIT, sampling call stack of C program into `profiler`
+    ExitCode run(SamplingProfiler& profiler);
+    // run without JIT, sampling resident set size of CAMI process into `sampler`
+    ExitCode run(MemorySampler& sampler);
+    template<typename Monitor>
+    void execute(Monitor& monitor);
+
+    [[nodiscard]] uint64_t executedInstructionCount() const noexcept
+    {
+        return this->state.executed_instr_cnt;
+    }
+
+    [[nodiscard]] size_t maxOperandStackDepth() const noexcept
+    {
+        return this->operand_stack.maxDepth();
+    }
+
+    // (hit count, miss count) of call site caches
+    [[nodiscard]] std::pair<uint64_t, uint64_t> callSiteCacheStatistics() const noexcept
+    {
+        return {this->state.call_site_cache_hit_cnt, this->state.call_site_cache_miss_cnt};
+    }
+
+    // (hit count, miss count) of heap TLB
+    [[nodiscard]] std::pair<uint64_t, uint64_t> heapTLBStatistics() const noexcept
+    {
+        return this->memory.heapTLBStatistics();
+    }
+
+    // whether heap is served by flat segment, beyond which heap TLB is used only
+    [[nodiscard]] bool usesFlatHeapSegment() const noexcept
+    {
+        return this->memory.usesFlatHeapSegment();
+    }
+
+    // tiering decisions made by JIT and hottest `top_n` loops left in interpreter
+    [[nodiscard]] std::string tieringReport(size_t top_n) const;
 private:
+    template<typename Monitor>
+    ExitCode do_run(Monitor& monitor);
+    // execute until halt(return false) or control is transferred to a function whose `verified` flag differs
+    //   from `verified` or which has native code(return true)
+    template<bool verified, typename Monitor>
+    bool do_execute(Monitor& monitor);
+    template<bool verified, typename Monitor>
+    [[nodiscard]] bool shouldSwitchExecutionMode() noexcept;
     [[nodiscard]] bool isValidEntityAddress(uint64_t addr) const noexcept
     {
         auto func_addr = reinterpret_cast<uintptr_t>(this->static_info.functions.data());
@@ -91,6 +209,9 @@ private:
     static tr::LinkedMBC& preprocessBytecode(tr::LinkedMBC& bytecode);
     spd::Global initStaticInfo(tr::LinkedMBC& bytecode);
     static uint64_t countPermanentObject(tr::LinkedMBC& bytecode);
+    static lib::Array<MemberAccessCache> createMemberAccessCaches(lib::Array<DecodedInstr>& instructions);
+    static lib::Array<CallSiteCache> createCallSiteCaches(lib::Array<DecodedInstr>& instructions);
+    static lib::Array<CastPlan> createCastPlans(const lib::Array<const ts::Type*>& types);
 };
 
 } // namespace cami::am
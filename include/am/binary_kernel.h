@@ -0,0 +1,315 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef CAMI_AM_BINARY_KERNEL_H
+#define CAMI_AM_BINARY_KERNEL_H
+
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <foundation/value.h>
+#include <foundation/type/helper.h>
+#include <lib/overflow.h>
+#include "fetch_decode.h"
+
+namespace cami::am {
+// binary operator kernels specialized for kinds of arithmetic operands, indexed by [opcode][lhs kind][rhs kind]
+// a kernel performs integer promotion(or usual arithmetic conversion), computation and writing the result
+//   back to lhs in one pass, with all kinds resolved at compile time.
+// if UB may occur(e.g. overflow, division by zero), a kernel returns false without modifying operands and
+//   the generic implementation(i.e. operators of `ValueBox`) is used as slow path to report it, so that
+//   kernels needn't reproduce diagnostics. Operands of other kinds(e.g. pointer) always go through slow path.
+class BinaryOperatorKernel
+{
+    using Kind = ts::Kind;
+    using Kernel = bool (*)(ValueBox& lhs, const ValueBox& rhs);
+    static constexpr size_t opcode_num = static_cast<size_t>(Opcode::xor_) - static_cast<size_t>(Opcode::mul) + 1;
+    static constexpr size_t kind_num = static_cast<size_t>(Kind::f64) + 1;
+    using Table = std::array<std::array<std::array<Kernel, kind_num>, kind_num>, opcode_num>;
+public:
+    static bool apply(Opcode op, ValueBox& lhs, const ValueBox& rhs)
+    {
+        auto lhs_kind = static_cast<size_t>(lhs->getType().kind());
+        auto rhs_kind = static_cast<size_t>(rhs->getType().kind());
+        if (lhs_kind >= kind_num || rhs_kind >= kind_num) {
+            return false;
+        }
+        auto kernel = table[static_cast<size_t>(op) - static_cast<size_t>(Opcode::mul)][lhs_kind][rhs_kind];
+        return kernel != nullptr && kernel(lhs, rhs);
+    }
+
+private:
+    static constexpr bool isIntegerKind(Kind kind)
+    {
+        return kind <= Kind::i64 || (kind >= Kind::u8 && kind <= Kind::u64);
+    }
+
+    static constexpr bool isComparison(Opcode op)
+    {
+        return op >= Opcode::sl && op <= Opcode::sne;
+    }
+
+    // same as `ValueBox::integerPromote`
+    static constexpr Kind promote(Kind kind)
+    {
+        switch (kind) {
+        case Kind::char_:
+        case Kind::i8:
+        case Kind::i16:
+            return Kind::i32;
+        case Kind::bool_:
+        case Kind::u8:
+        case Kind::u16:
+            return Kind::u32;
+        default:
+            return kind;
+        }
+    }
+
+    // common kind of integer operands, same as `ValueBox::usualArithmeticConvert`
+    static constexpr Kind commonKind(Kind lhs, Kind rhs)
+    {
+        auto lhs_promoted = promote(lhs);
+        auto rhs_promoted = promote(rhs);
+        if (lhs == rhs) {
+            return lhs_promoted;
+        }
+        if (ts::isUnsigned(lhs) == ts::isUnsigned(rhs)) {
+            return ts::integerTypeRank(lhs) > ts::integerTypeRank(rhs) ? lhs_promoted : rhs_promoted;
+        }
+        auto signed_ = ts::isSigned(lhs) ? lhs_promoted : rhs_promoted;
+        auto unsigned_ = ts::isSigned(lhs) ? rhs_promoted : lhs_promoted;
+        if (ts::integerTypeRank(unsigned_) > ts::integerTypeRank(signed_)) {
+            return unsigned_;
+        }
+        if (signed_ == Kind::i64 && unsigned_ == Kind::u32) {
+            return signed_;
+        }
+        return ts::correspondingUnsignedKind(signed_);
+    }
+
+    // same as `IntegerValue::extend`, `kind` is promoted
+    template<Kind kind>
+    static uint64_t extend(uint64_t value) noexcept
+    {
+        if constexpr (kind == Kind::u64 || kind == Kind::i64) {
+            return value;
+        } else if constexpr (kind == Kind::u32) {
+            return value & 0xffff'ffff;
+        } else {
+            static_assert(kind == Kind::i32);
+            return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(value)));
+        }
+    }
+
+    template<Kind kind>
+    static void setInteger(IntegerValue& v, uint64_t value) noexcept
+    {
+        v.type = &ts::type_manager.getBasicType(kind);
+        v.val = value;
+    }
+
+    template<Opcode op, Kind lhs_kind>
+    static bool shift(IntegerValue& lhs, uint64_t rhs) noexcept
+    {
+        constexpr Kind kind = promote(lhs_kind);
+        constexpr uint64_t width = ts::correspondingUnsignedKind(kind) == Kind::u32 ? 32 : 64;
+        if (rhs >= width) { // also covers negative rhs
+            return false;
+        }
+        uint64_t result;
+        if constexpr (op == Opcode::ls) {
+            result = lhs.val << rhs;
+            if constexpr (ts::isSigned(kind)) {
+                if (lhs.val >> 63 || result >> (width - 1) != 0) {
+                    return false;
+                }
+            }
+        } else {
+            result = lhs.val >> rhs;
+        }
+        setInteger<kind>(lhs, extend<kind>(result));
+        return true;
+    }
+
+    template<Opcode op, Kind lhs_kind, Kind rhs_kind>
+    static bool integerKernel(ValueBox& lhs_vb, const ValueBox& rhs_vb) noexcept
+    {
+        auto& lhs = lhs_vb.get<IntegerValue>();
+        const uint64_t rhs = rhs_vb.get<IntegerValue>().val;
+        if constexpr (op == Opcode::ls || op == Opcode::rs) {
+            return shift<op, lhs_kind>(lhs, rhs);
+        } else {
+            constexpr Kind kind = commonKind(lhs_kind, rhs_kind);
+            const uint64_t a = lhs.val;
+            // `a - b` is evaluated as `a + (-b)` in generic implementation
+            const uint64_t b = op == Opcode::sub ? extend<kind>(-rhs) : rhs;
+            const auto sa = static_cast<int64_t>(a);
+            const auto sb = static_cast<int64_t>(b);
+            if constexpr (isComparison(op)) {
+                bool result;
+                if constexpr (op == Opcode::seq || op == Opcode::sne) {
+                    result = (a == b) == (op == Opcode::seq);
+                } else if constexpr (ts::isUnsigned(kind)) {
+                    result = op == Opcode::sl ? a < b : op == Opcode::sle ? a <= b : op == Opcode::sg ? a > b : a >= b;
+                } else {
+                    result = op == Opcode::sl ? sa < sb : op == Opcode::sle ? sa <= sb : op == Opcode::sg ? sa > sb : sa >= sb;
+                }
+                setInteger<Kind::i32>(lhs, result);
+                return true;
+            } else {
+                uint64_t result;
+                if constexpr (op == Opcode::add || op == Opcode::sub) {
+                    result = a + b;
+                    if constexpr (kind == Kind::i32) {
+                        int32_t tmp;
+                        if (lib::addOverflow(static_cast<int32_t>(sa), static_cast<int32_t>(sb), &tmp)) {
+                            return false;
+                        }
+                    } else if constexpr (kind == Kind::i64) {
+                        int64_t tmp;
+                        if (lib::addOverflow(sa, sb, &tmp)) {
+                            return false;
+                        }
+                    }
+                } else if constexpr (op == Opcode::mul) {
+                    if constexpr (ts::isUnsigned(kind)) {
+                        result = a * b;
+                    } else if constexpr (kind == Kind::i32) {
+                        int32_t tmp;
+                        if (lib::mulOverflow(static_cast<int32_t>(sa), static_cast<int32_t>(sb), &tmp)) {
+                            return false;
+                        }
+                        result = static_cast<int64_t>(tmp);
+                    } else {
+                        int64_t tmp;
+                        if (lib::mulOverflow(sa, sb, &tmp)) {
+                            return false;
+                        }
+                        result = tmp;
+                    }
+                } else if constexpr (op == Opcode::div || op == Opcode::mod) {
+                    if (b == 0) {
+                        return false;
+                    }
+                    if constexpr (ts::isUnsigned(kind)) {
+                        result = op == Opcode::div ? a / b : a % b;
+                    } else {
+                        if (sa == (kind == Kind::i32 ? INT32_MIN : INT64_MIN) && sb == -1) {
+                            return false;
+                        }
+                        result = op == Opcode::div ? sa / sb : sa % sb;
+                    }
+                } else if constexpr (op == Opcode::and_) {
+                    result = a & b;
+                } else if constexpr (op == Opcode::or_) {
+                    result = a | b;
+                } else {
+                    static_assert(op == Opcode::xor_);
+                    result = a ^ b;
+                }
+                setInteger<kind>(lhs, extend<kind>(result));
+                return true;
+            }
+        }
+    }
+
+    template<Kind kind>
+    static auto floatOf(const ValueBox& vb) noexcept
+    {
+        if constexpr (kind == Kind::f32) {
+            return vb.get<F32Value>().val;
+        } else {
+            return vb.get<F64Value>().val;
+        }
+    }
+
+    template<Opcode op, Kind lhs_kind, Kind rhs_kind>
+    static bool floatKernel(ValueBox& lhs, const ValueBox& rhs) noexcept
+    {
+        // operands are converted to `f64` unless both are `f32`
+        using T = std::conditional_t<lhs_kind == Kind::f32 && rhs_kind == Kind::f32, float, double>;
+        const T a = floatOf<lhs_kind>(lhs);
+        const T b = floatOf<rhs_kind>(rhs);
+        if constexpr (isComparison(op)) {
+            bool result = op == Opcode::sl ? a < b : op == Opcode::sle ? a <= b : op == Opcode::sg ? !(a <= b) :
+                          op == Opcode::sge ? !(a < b) : (a == b) == (op == Opcode::seq);
+            lhs.emplace<IntegerValue>(&ts::type_manager.getBasicType(Kind::i32), result);
+            return true;
+        } else {
+            T result;
+            if constexpr (op == Opcode::add) {
+                result = a + b;
+            } else if constexpr (op == Opcode::sub) {
+                result = a + -b;
+            } else if constexpr (op == Opcode::mul) {
+                result = a * b;
+            } else {
+                static_assert(op == Opcode::div);
+                if (b == 0) {
+                    return false;
+                }
+                result = a / b;
+            }
+            if constexpr (std::is_same_v<T, float>) {
+                lhs.get<F32Value>().val = result;
+            } else if constexpr (lhs_kind == Kind::f64) {
+                lhs.get<F64Value>().val = result;
+            } else {
+                lhs.emplace<F64Value>(result);
+            }
+            return true;
+        }
+    }
+
+    template<Opcode op, Kind lhs_kind, Kind rhs_kind>
+    static constexpr Kernel select()
+    {
+        if constexpr (isIntegerKind(lhs_kind) && isIntegerKind(rhs_kind)) {
+            return &integerKernel<op, lhs_kind, rhs_kind>;
+        } else if constexpr (ts::isFloat(lhs_kind) && ts::isFloat(rhs_kind) && (isComparison(op) || op == Opcode::add ||
+                             op == Opcode::sub || op == Opcode::mul || op == Opcode::div)) {
+            return &floatKernel<op, lhs_kind, rhs_kind>;
+        } else {
+            return nullptr;
+        }
+    }
+
+    template<size_t op, size_t lhs_kind, size_t... rhs_kinds>
+    static constexpr std::array<Kernel, kind_num> makeRow(std::index_sequence<rhs_kinds...>)
+    {
+        return {select<static_cast<Opcode>(static_cast<size_t>(Opcode::mul) + op),
+                       static_cast<Kind>(lhs_kind), static_cast<Kind>(rhs_kinds)>()...};
+    }
+
+    template<size_t op, size_t... lhs_kinds>
+    static constexpr std::array<std::array<Kernel, kind_num>, kind_num> makePlane(std::index_sequence<lhs_kinds...>)
+    {
+        return {makeRow<op, lhs_kinds>(std::make_index_sequence<kind_num>{})...};
+    }
+
+    template<size_t... ops>
+    static constexpr Table makeTable(std::index_sequence<ops...>)
+    {
+        return {makePlane<ops>(std::make_index_sequence<kind_num>{})...};
+    }
+
+    static const Table table;
+};
+
+} // namespace cami::am
+
+#endif //CAMI_AM_BINARY_KERNEL_H
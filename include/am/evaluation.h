@@ -17,7 +17,7 @@
 #ifndef CAMI_AM_EVALUATION_H
 #define CAMI_AM_EVALUATION_H
 
-#include <deque>
+#include <vector>
 #include <utility>
 #include <foundation/value.h>
 #include <lib/compiler_guarantee.h>
@@ -71,8 +71,17 @@ public:
     };
 
 private:
-    std::deque<RichValue> stack;
+    // RichValues are held in place in a contiguous buffer, which is reserved in advance and seldom grows
+    std::vector<RichValue> stack;
+    size_t max_depth = 0;
 public:
+    static constexpr size_t initial_capacity = 256;
+
+    OperandStack()
+    {
+        this->stack.reserve(OperandStack::initial_capacity);
+    }
+
     RichValue& top()
     {
         COMPILER_GUARANTEE(!this->stack.empty(), "read empty operand stack");
@@ -120,24 +129,45 @@ public:
     void push(ValueBox vb)
     {
         this->stack.emplace_back(std::move(vb), Attribute{});
+        this->updateMaxDepth();
     }
 
     void push(const RichValue& rich_value)
     {
         this->stack.push_back(rich_value);
+        this->updateMaxDepth();
     }
 
     void push(RichValue&& rich_value)
     {
         this->stack.push_back(std::move(rich_value));
+        this->updateMaxDepth();
     }
 
-    [[nodiscard]] const std::deque<RichValue>& getStack() const noexcept
+    [[nodiscard]] const std::vector<RichValue>& getStack() const noexcept
     {
         return this->stack;
     }
 
+    [[nodiscard]] size_t size() const noexcept
+    {
+        return this->stack.size();
+    }
+
+    // the maximum number of values ever held
+    [[nodiscard]] size_t maxDepth() const noexcept
+    {
+        return this->max_depth;
+    }
+
 private:
+    void updateMaxDepth() noexcept
+    {
+        if (this->stack.size() > this->max_depth) [[unlikely]] {
+            this->max_depth = this->stack.size();
+        }
+    }
+
     static bool referenceDestroyedObject(const ValueBox& vb) noexcept
     {
         if (vb->getType().kind() != ts::Kind::pointer) {
@@ -68,6 +68,13 @@ public:
             : IgnorableException(lib::format("memory access fault (from ${x}, len ${}): ${}", addr, len, what)) {}
 };
 
+class StackOverflowException : public IgnorableException
+{
+public:
+    explicit StackOverflowException(uint64_t size, uint64_t max_size)
+            : IgnorableException(lib::format("stack overflow: required stack size ${x} exceeds ${x}", size, max_size)) {}
+};
+
 class MMIOAccessException : public IgnorableException
 {
 public:
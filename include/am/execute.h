@@ -25,6 +25,9 @@
 namespace cami::am {
 struct Execute
 {
+    // handlers with template parameter `verified` skip checks which have been proved by tr::Verifier
+    //   if it is true, see also `spd::Function::verified`
+    template<bool verified = false>
     static void designate(AbstractMachine& am, InstrInfo info);
     static void dereference(AbstractMachine& am);
     static void read(AbstractMachine& am, InstrInfo info);
@@ -32,27 +35,36 @@ struct Execute
     static void zero(AbstractMachine& am, InstrInfo info);
     static void writeInit(AbstractMachine& am);
     static void zeroInit(AbstractMachine& am);
+    template<bool verified = false>
     static void enterBlock(AbstractMachine& am, InstrInfo info);
+    template<bool verified = false>
     static void leaveBlock(AbstractMachine& am);
+    template<bool verified = false>
     static void newObject(AbstractMachine& am, InstrInfo info);
     static void deleteObject(AbstractMachine& am, InstrInfo info);
     static void fullExpression(AbstractMachine& am, InstrInfo info);
+    template<bool verified = false>
     static void jump(AbstractMachine& am, InstrInfo info);
+    template<bool verified = false>
     static void jumpIfSet(AbstractMachine& am, InstrInfo info);
+    template<bool verified = false>
     static void jumpIfNotSet(AbstractMachine& am, InstrInfo info);
     static void call(AbstractMachine& am, InstrInfo);
     static void indirectJump(AbstractMachine& am);
     static void ret(AbstractMachine& am);
     static void pushUndefined(AbstractMachine& am);
+    template<bool verified = false>
     static void push(AbstractMachine& am, InstrInfo info);
     static void pop(AbstractMachine& am);
     static void duplicate(AbstractMachine& am);
     static void dot(AbstractMachine& am, InstrInfo info);
     static void arrow(AbstractMachine& am, InstrInfo info);
     static void address(AbstractMachine& am);
+    template<bool verified = false>
     static void cast(AbstractMachine& am, InstrInfo info);
     static void unaryOperator(AbstractMachine& am, Opcode op);
     static void binaryOperator(AbstractMachine& am, Opcode op);
+    static CastPlan createCastPlan(const ts::Type& type);
 private:
     static void modifyCheck(AbstractMachine& am, bool ignore_const);
     static void basicModifyCheck(AbstractMachine& am, bool ignore_const);
@@ -60,10 +72,25 @@ private:
     static void do_modify(AbstractMachine& am, ValueBox vb);
     static void modifyPointerObjectInCharacterType(AbstractMachine& am, Object& obj, uint64_t value);
     static void accessMember(AbstractMachine& am, const Entity* entity, const ts::Type* lvalue_type, uint32_t member_id);
+    // inline caches of the instruction being executed, i.e. the one just before pc
+    static MemberAccessCache& memberAccessCache(AbstractMachine& am)
+    {
+        return am.member_access_caches[am.instructions[am.state.pc - 4 - layout::CODE_BASE].cache_id];
+    }
+
+    static CallSiteCache& callSiteCache(AbstractMachine& am)
+    {
+        return am.call_site_caches[am.instructions[am.state.pc - 4 - layout::CODE_BASE].cache_id];
+    }
+
+    template<bool verified>
     static void do_enterBlock(AbstractMachine& am, uint32_t block_id);
     static void checkJumpAddr(AbstractMachine& am, uint64_t target_pc);
+    // routines of `CastPlan`, `castGenerically` handles all combinations of types of operand and `plan.type`
+    static void castGenerically(AbstractMachine& am, ValueBox& operand, const CastPlan& plan);
     static void castIntegerToPointer(AbstractMachine& am, ValueBox& operand, const ts::Type& type);
-    static void castPointerToPointer(ValueBox& operand, const ts::Type& type);
+    static void castPointerToPointer(AbstractMachine& am, ValueBox& operand, const CastPlan& plan);
+    static void castDissociativePointerToPointer(AbstractMachine& am, ValueBox& operand, const CastPlan& plan);
 
     static void attachTag(AbstractMachine& am, Object& object, InnerID inner_id)
     {
@@ -20,7 +20,8 @@
 #include <cstdint>
 #include <lib/bitmap.h>
 #include <lib/format.h>
-#include "am.h"
+#include <lib/array.h>
+#include "vmm.h"
 
 namespace cami::am {
 
@@ -32,6 +33,8 @@ enum class Opcode : uint8_t
     nop = 0, pushu /* push undef */ = 251, push = 252, pop = 253, dup = 254, halt = 255,
     dot = 128, arrow, addr, cast, cpl, pos, neg, not_, mul, div, mod,
     add, sub, ls, rs, sl, sle, sg, sge, seq, sne, and_, or_, xor_,
+    // superinstructions, which only exist in pre-decoded instruction stream
+    fe_dsg = 8, dsg_read, dsg_addr, dsg_mdf, push_add, push_cast, fe_dsg_read, dsg_addr_call,
 };
 
 struct InstrInfo
@@ -134,6 +137,15 @@ public:
     }
 };
 
+// pre-decoded form of the instruction starting at a certain code offset
+struct DecodedInstr
+{
+    Opcode op;
+    uint8_t length; // 0 means that the instruction is truncated by the end of code segment
+    uint32_t cache_id; // index of inline cache, only used by `dot`, `arrow` and `call`
+    InstrInfo info;
+};
+
 class AbstractMachine;
 
 class FetchDecode
@@ -167,8 +179,21 @@ public:
         return ops.test(static_cast<uint64_t>(op));
     }
 
+    static constexpr bool isSuperinstruction(Opcode op)
+    {
+        return op >= Opcode::fe_dsg && op <= Opcode::dsg_addr_call;
+    }
+
     static std::pair<Opcode, InstrInfo> decode(AbstractMachine& am);
+    // decode the following component of a superinstruction
+    static InstrInfo decodeFollowing(AbstractMachine& am);
+    static lib::Array<DecodedInstr> predecode(const lib::Array<uint8_t>& code);
+    // rewrite hot instruction sequences of pre-decoded instruction stream into superinstructions
+    static void fuse(AbstractMachine& am);
+    // opcode of the first component if `op` is a superinstruction, otherwise `op` itself
+    static Opcode unfuse(Opcode op) noexcept;
 private:
+    static std::pair<Opcode, InstrInfo> decodeFromMemory(AbstractMachine& am);
     static uint32_t readUint24(VirtualMemory& memory, uint64_t pc);
     static int64_t readInt24(VirtualMemory& memory, uint64_t pc);
 };
@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef CAMI_AM_JIT_H
+#define CAMI_AM_JIT_H
+
+#include <config.h>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+#include <lib/array.h>
+#include "fetch_decode.h"
+
+// native code is emitted for x86-64 System V ABI, and code buffer is allocated by `mmap`
+#if defined(CAMI_ENABLE_JIT) && defined(__x86_64__) && defined(__unix__)
+#define CAMI_AM_JIT
+#endif
+
+namespace cami::am {
+
+namespace spd {
+struct Function;
+}
+
+// Baseline template JIT.
+// Each instruction of a function is translated to a native call of the corresponding `Execute` handler
+//   (through a thunk), with the pre-decoded operand baked in as immediate. Jumps whose targets are known
+//   are linked directly, and `call`/`ret` continue at the native code of the target function if any.
+// Since the same handlers are called in the same order, trace events, UB detection and all other
+//   observable behaviors are identical to the interpreter. Anything not supported (e.g. `halt`,
+//   invalid instructions) leaves native code and is executed by the interpreter.
+//
+// Functions start in the interpreter and are promoted(compiled) once they are hot, i.e.
+//   + a backward jump(loop) in it is taken `hot_loop_threshold` times, or
+//   + it is called `hot_function_threshold` times.
+// A threshold of 0 promotes all functions before execution.
+class JIT
+{
+    struct CodeChunk
+    {
+        uint8_t* address;
+        size_t size;
+    };
+
+    struct Promotion
+    {
+        uint64_t function_index;
+        uint64_t site_pc; // pc of the hot backward jump, 0 for hot function
+        uint64_t count; // value of counter when promoted
+        uint64_t executed_instr_cnt; // time of promotion
+    };
+
+    std::vector<CodeChunk> chunks{}; // the first chunk holds entry stub
+    // native address of the instruction starting at each code offset, nullptr if not compiled
+    lib::Array<const void*> native_addresses{};
+    // exception thrown by a handler, which is rethrown after native code returns
+    std::exception_ptr pending_exception{};
+    // tiering
+    uint64_t hot_loop_threshold = CAMI_JIT_HOT_LOOP_THRESHOLD;
+    uint64_t hot_function_threshold = CAMI_JIT_HOT_FUNCTION_THRESHOLD;
+    lib::Array<uint64_t> backward_jump_counters{}; // indexed by code offset of jump instruction
+    lib::Array<uint64_t> call_counters{}; // indexed by function index
+    std::vector<bool> promoted{}; // indexed by function index
+    std::vector<Promotion> promotions{};
+
+public:
+    JIT() = default;
+    JIT(const JIT&) = delete;
+    JIT& operator=(const JIT&) = delete;
+    ~JIT();
+
+    void init(AbstractMachine& am);
+
+    [[nodiscard]] bool hasNativeCode(uint64_t pc) const noexcept
+    {
+        return this->nativeAddress(pc) != nullptr;
+    }
+
+    // execute native code starting at current pc until an unsupported instruction is met
+    // return false if there is no native code for current pc
+    bool enter(AbstractMachine& am);
+    // called by interpreter when a backward jump is taken, `next_pc` is the address following the jump
+    //   instruction. return true if current function is promoted
+    bool onBackwardJump(AbstractMachine& am, uint64_t next_pc);
+    // called when a function is called (i.e. after `call` is executed)
+    void onCall(AbstractMachine& am);
+    [[nodiscard]] std::string report(const AbstractMachine& am, size_t top_n) const;
+
+private:
+    enum class ThunkKind
+    {
+        plain, // continue at next instruction
+        branch, // continue at next instruction or jump target
+        transfer, // continue at the native address returned by thunk
+        unsupported
+    };
+
+    struct Thunk
+    {
+        ThunkKind kind;
+        const void* address;
+    };
+
+    [[nodiscard]] const void* nativeAddress(uint64_t pc) const noexcept;
+    void promote(AbstractMachine& am, uint64_t function_index, uint64_t site_pc, uint64_t count);
+    void compileFunction(AbstractMachine& am, const spd::Function& func);
+    // `call` with tiering counting
+    static void call(AbstractMachine& am, InstrInfo info);
+    template<bool verified>
+    static Thunk selectThunk(Opcode op, bool static_target) noexcept;
+    template<auto handler>
+    static bool plainThunk(AbstractMachine& am, const DecodedInstr& instr, uint64_t next_pc) noexcept;
+    template<auto handler>
+    static int branchThunk(AbstractMachine& am, const DecodedInstr& instr, uint64_t next_pc) noexcept;
+    template<auto handler>
+    static const void* transferThunk(AbstractMachine& am, const DecodedInstr& instr, uint64_t next_pc) noexcept;
+    template<auto handler>
+    static void invoke(AbstractMachine& am, const DecodedInstr& instr, uint64_t next_pc);
+};
+
+} // namespace cami::am
+
+#endif //CAMI_AM_JIT_H
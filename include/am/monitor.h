@@ -0,0 +1,203 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef CAMI_AM_MONITOR_H
+#define CAMI_AM_MONITOR_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "fetch_decode.h"
+#include "evaluation.h"
+#include "state.h"
+
+namespace cami::am {
+
+// A monitor observes every instruction dispatched by `AbstractMachine::execute`.
+// Each kind of monitor leads to a separate instantiation of `execute`, so that monitoring
+//   costs nothing if it is not required.
+struct NullMonitor
+{
+    static constexpr bool allow_superinstruction = true;
+    static constexpr bool allow_jit = true;
+
+    void onDispatch(Opcode, const state::Global&, const OperandStack&) noexcept {}
+};
+
+// count dynamic opcode pairs and triples, used to find candidates of superinstruction
+class OpcodeHistogram
+{
+    uint64_t pairs[256][256]{};
+    std::unordered_map<uint32_t, uint64_t> triples{};
+    // opcodes of last two dispatched instructions, -1 means none
+    int prev1 = -1;
+    int prev2 = -1;
+public:
+    static constexpr bool allow_superinstruction = false;
+    static constexpr bool allow_jit = false;
+
+    void onDispatch(Opcode op, const state::Global&, const OperandStack&)
+    {
+        auto cur = static_cast<uint8_t>(op);
+        if (this->prev1 >= 0) {
+            this->pairs[this->prev1][cur]++;
+            if (this->prev2 >= 0) {
+                this->triples[this->prev2 << 16 | this->prev1 << 8 | cur]++;
+            }
+        }
+        this->prev2 = this->prev1;
+        this->prev1 = cur;
+    }
+
+    [[nodiscard]] std::string report(size_t top_n) const;
+};
+
+// execution count, time and average operand stack depth of each opcode
+// time spent between two dispatches is attributed to the former instruction
+class OpcodeProfiler
+{
+    struct Record
+    {
+        uint64_t count = 0;
+        uint64_t time = 0;
+        uint64_t stack_depth_sum = 0;
+    };
+
+    Record records[256]{};
+    int prev = -1; // opcode of last dispatched instruction, -1 means none
+    uint64_t prev_time = 0;
+public:
+    static constexpr bool allow_superinstruction = false;
+    static constexpr bool allow_jit = false;
+#if defined(__x86_64__) || defined(__i386__)
+    static constexpr const char* time_unit = "cycles";
+#else
+    static constexpr const char* time_unit = "ns";
+#endif
+
+    void onDispatch(Opcode op, const state::Global&, const OperandStack& stack) noexcept
+    {
+        auto cur = static_cast<uint8_t>(op);
+        if (this->prev >= 0) {
+            this->records[this->prev].time += OpcodeProfiler::now() - this->prev_time;
+        }
+        this->records[cur].count++;
+        this->records[cur].stack_depth_sum += stack.size();
+        this->prev = cur;
+        // read again to exclude the cost of bookkeeping above
+        this->prev_time = OpcodeProfiler::now();
+    }
+
+    // attribute time of the last executed instruction
+    void stop() noexcept
+    {
+        if (this->prev >= 0) {
+            this->records[this->prev].time += OpcodeProfiler::now() - this->prev_time;
+            this->prev = -1;
+        }
+    }
+
+    // sorted by time in descending order
+    [[nodiscard]] std::string report() const;
+    [[nodiscard]] std::string toJson() const;
+private:
+    static uint64_t now() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    [[nodiscard]] std::vector<uint8_t> sortedOpcodes() const;
+};
+
+// sample the call stack every `interval` instructions, frames of which are `function:line`
+// output is in collapsed format accepted by flame graph tools (e.g. flamegraph.pl, speedscope)
+class SamplingProfiler
+{
+    uint64_t interval;
+    uint64_t countdown;
+    std::unordered_map<std::string, uint64_t> stacks{};
+    uint64_t sample_cnt = 0;
+public:
+    static constexpr bool allow_superinstruction = true;
+    static constexpr bool allow_jit = false;
+
+    explicit SamplingProfiler(uint64_t interval) : interval(interval), countdown(interval) {}
+
+    void onDispatch(Opcode, const state::Global& state, const OperandStack&)
+    {
+        if (--this->countdown == 0) [[unlikely]] {
+            this->countdown = this->interval;
+            this->sample(state);
+        }
+    }
+
+    [[nodiscard]] uint64_t sampleCount() const noexcept
+    {
+        return this->sample_cnt;
+    }
+
+    // one line per distinct stack, in lexicographical order
+    [[nodiscard]] std::string collapsedStacks() const;
+private:
+    void sample(const state::Global& state);
+};
+
+// sample resident set size of CAMI process every `interval` instructions
+class MemorySampler
+{
+    uint64_t interval;
+    uint64_t countdown;
+    // (executed instruction count, resident set size in bytes)
+    std::vector<std::pair<uint64_t, uint64_t>> samples{};
+public:
+    static constexpr bool allow_superinstruction = true;
+    static constexpr bool allow_jit = false;
+
+    explicit MemorySampler(uint64_t interval) : interval(interval), countdown(interval) {}
+
+    void onDispatch(Opcode, const state::Global& state, const OperandStack&)
+    {
+        if (--this->countdown == 0) [[unlikely]] {
+            this->countdown = this->interval;
+            this->samples.emplace_back(state.executed_instr_cnt, MemorySampler::residentSetSize());
+        }
+    }
+
+    [[nodiscard]] uint64_t sampleCount() const noexcept
+    {
+        return this->samples.size();
+    }
+
+    [[nodiscard]] uint64_t peak() const noexcept;
+    // one line per sample, in format `instructions,rss_bytes`
+    [[nodiscard]] std::string toCsv() const;
+    // 0 if not supported by the platform
+    static uint64_t residentSetSize() noexcept;
+};
+
+} // namespace cami::am
+
+#endif //CAMI_AM_MONITOR_H
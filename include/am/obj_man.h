@@ -207,6 +207,8 @@ public:
     }
 
     lib::Optional<Object*> getReferencedObject(const Object* obj) const;
+    // top object whose storage contains `address`, if any
+    [[nodiscard]] lib::Optional<Object*> findTopObject(uint64_t address) const;
 
     [[nodiscard]] bool isValidObjectAddress(uintptr_t addr) const noexcept
     {
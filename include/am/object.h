@@ -98,21 +98,23 @@ public:
     lib::Optional<Object*> super_object;
     lib::Array<Object*> sub_objects;
     std::set<Object*> referenced_by;
+    // host memory backing the object, resolved at creation; nullptr if it must be accessed via `VirtualMemory`
+    uint8_t* const host_address;
 public:
     Object(const Object&) = delete;
     Object& operator=(const Object&) = delete;
 private:
     friend class am::ObjectManager;
 
-    Object(std::string name, const ts::Type& type, uint64_t address,
+    Object(std::string name, const ts::Type& type, uint64_t address, uint8_t* host_address,
            lib::Optional<Object*> super_object, lib::Array<Object*> sub_objects)
             : Entity(std::move(name), type, address),
-              super_object(super_object), sub_objects(std::move(sub_objects)) {}
+              super_object(super_object), sub_objects(std::move(sub_objects)), host_address(host_address) {}
 
     Object(Object&& that) noexcept : Entity(std::move(that.name), that.effective_type, that.address),
                                      status(that.status), age(that.age), tags(std::move(that.tags)),
                                      super_object(that.super_object), sub_objects(std::move(that.sub_objects)),
-                                     referenced_by(std::move(that.referenced_by)) {}
+                                     referenced_by(std::move(that.referenced_by)), host_address(that.host_address) {}
 
 public:
     [[nodiscard]] bool isIndeterminateRepresentation() const noexcept
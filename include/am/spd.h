@@ -27,6 +27,7 @@
 #include <lib/optional.h>
 #include <foundation/value.h>
 #include "object.h"
+#include "evaluation.h"
 #include "trace_data.h"
 
 namespace cami::am::spd {
@@ -64,10 +65,10 @@ public:
     explicit SourceCodeLocator(lib::Array<Item> data) : data(std::move(data)) {}
 
 public:
-    u64_opt getSourceLine(uint64_t addr)
+    [[nodiscard]] u64_opt getSourceLine(uint64_t addr) const
     {
         auto itr = std::upper_bound(data.begin(), data.end(), addr, [](uint64_t a, const Item& b) {
-            return a > b.addr;
+            return a < b.addr;
         });
         if (itr == this->data.begin()) {
             return {};
@@ -115,6 +116,7 @@ struct Function : public Entity
     lib::Array<Block> blocks;
     lib::Array<FullExprInfo> full_expr_infos; // indexed by full expr id
     SourceCodeLocator func_locator;
+    bool verified = false; // set by tr::Verifier, enables handlers skipping checks proved statically
 
     Function(std::string name, const ts::Type& type, uint64_t address, std::string file_name,
              size_t frame_size, size_t code_size, size_t max_object_num, lib::Array<Block> blocks,
@@ -123,7 +125,7 @@ struct Function : public Entity
               code_size(code_size), max_object_num(max_object_num), blocks(std::move(blocks)),
               full_expr_infos(std::move(full_expr_infos)), func_locator(std::move(func_locator)) {}
 
-    u64_opt getSourceLine(uint64_t addr)
+    [[nodiscard]] u64_opt getSourceLine(uint64_t addr) const
     {
         return this->func_locator.getSourceLine(addr - this->address);
     }
@@ -132,11 +134,13 @@ struct Function : public Entity
 struct Global
 {
     lib::Array<Object*> static_objects; // object_manager has the ownership of item of static_objects
-    lib::Array<ValueBox> constants;
+    // constants are immutable and kept as ready-made operand stack slots, so `push` is a single slot copy;
+    //   the linker places the most referenced ones first
+    lib::Array<OperandStack::RichValue> constants;
     lib::Array<const ts::Type*> types; // used by cast operator
     lib::Array<Function> functions;
 
-    Global(lib::Array<Object*> static_objects, lib::Array<ValueBox> constants,
+    Global(lib::Array<Object*> static_objects, lib::Array<OperandStack::RichValue> constants,
            lib::Array<const ts::Type*> types, lib::Array<Function> functions)
             : static_objects(std::move(static_objects)), constants(std::move(constants)),
               types(std::move(types)), functions(std::move(functions)) {}
@@ -20,6 +20,7 @@
 #include <cstdint>
 #include <stack>
 #include <map>
+#include <vector>
 #include <utility>
 #include <lib/array.h>
 #include <lib/list.h>
@@ -37,14 +38,17 @@ struct Function
 {
     const spd::Function* static_info;
     uint64_t return_address;
+    uint64_t frame_pointer;
     lib::Array<Object*> automatic_objects;
     std::stack<uint64_t> blocks{};
     TraceContext& context;
     uint32_t cur_full_expr_id = 0;
     uint64_t full_expr_exec_cnt = 0;
 
-    Function(const spd::Function* static_info, uint64_t return_address, size_t max_object_num, TraceContext& context)
-            : static_info(static_info), return_address(return_address), automatic_objects(max_object_num),
+    Function(const spd::Function* static_info, uint64_t return_address, uint64_t frame_pointer, size_t max_object_num,
+             TraceContext& context)
+            : static_info(static_info), return_address(return_address), frame_pointer(frame_pointer),
+              automatic_objects(max_object_num),
               context(context)
     {
         for (auto& item: this->automatic_objects) {
@@ -63,8 +67,13 @@ struct Global
     uint64_t pc = layout::CODE_BASE;
     uint64_t frame_pointer = layout::STACK_BOUNDARY;
     std::deque<Function> call_stack{};
-    // all top objects and functions(used by indirectly access i.e. integer => pointer)
-    std::map<uint64_t, Entity*> entities{};
+    // top objects indexed by address(used by indirectly access i.e. integer => pointer), see `ObjectManager::findTopObject`
+    //   automatic objects are found through `automatic_objects` of the frame containing the address instead
+    std::vector<Object*> static_object_index{}; // sorted by address, static objects are never destroyed
+    std::map<uint64_t, Object*> heap_object_index{}; // keyed by address, i.e. start of the interval occupied
+    uint64_t executed_instr_cnt = 0;
+    uint64_t call_site_cache_hit_cnt = 0;
+    uint64_t call_site_cache_miss_cnt = 0;
 
     explicit Global(const Function& boot_function)
     {
@@ -20,7 +20,8 @@
 #include <config.h>
 #include <cstddef>
 #include <cstdint>
-#include <deque>
+#include <utility>
+#include <set>
 #include "object.h"
 #include "exception.h"
 #include <foundation/cross_platform.h>
@@ -29,6 +30,11 @@
 #include <lib/shared_ptr.h>
 #include <lib/format.h>
 
+// flat heap segment relies on `mmap` with `MAP_NORESERVE`
+#if defined(CAMI_MEMORY_HEAP_ENABLE_FLAT_SEGMENT) && defined(CAMI_TARGET_INFO_UNIX_LIKE)
+#define CAMI_AM_FLAT_HEAP
+#endif
+
 namespace cami::am {
 class ObjectManager;
 namespace layout {
@@ -57,6 +63,16 @@ class VirtualMemory
         static constexpr uint64_t TOTAL_PAGE_NUM = (layout::HEAP_BOUNDARY - layout::HEAP_BASE) / PAGE_SIZE;
         static constexpr std::size_t PAGE_TABLE_ITEM_NUM = lib::roundUpNthRoot(TOTAL_PAGE_NUM, PAGE_TABLE_LEVEL);
 
+        // number of pages covered by one item of page table in `level`(starts from 1)
+        static constexpr uint64_t itemSpan(std::size_t level) noexcept
+        {
+            uint64_t span = 1;
+            for (auto i = level; i < PAGE_TABLE_LEVEL; ++i) {
+                span *= PAGE_TABLE_ITEM_NUM;
+            }
+            return span;
+        }
+
         struct Page
         {
             uint8_t* data = new uint8_t[PAGE_SIZE]{};
@@ -75,12 +91,53 @@ class VirtualMemory
                 Page* page;
             } item[PAGE_TABLE_ITEM_NUM]{};
         };
-        PageTable* page_table = new PageTable{};
-
-        ~Heap()
+        // direct-mapped translation cache from heap page number to page, checked before walking page table.
+        //   only allocated pages are cached, entry is refreshed when page is allocated and invalidated when released
+        struct TLB
         {
-            deletePageTable(this->page_table, 1);
-        }
+            static constexpr std::size_t SIZE = 256;
+            static constexpr uint64_t INVALID_PAGE_NUMBER = UINT64_MAX;
+            struct Entry
+            {
+                uint64_t page_number = INVALID_PAGE_NUMBER;
+                Page* page = nullptr;
+            } entries[SIZE]{};
+            uint64_t hit_cnt = 0;
+            uint64_t miss_cnt = 0;
+
+            Entry& entry(uint64_t page_number) noexcept
+            {
+                return this->entries[page_number % SIZE];
+            }
+
+            void invalidate(uint64_t page_number) noexcept
+            {
+                if (auto& item = this->entry(page_number); item.page_number == page_number) {
+                    item = {};
+                }
+            }
+        };
+
+        PageTable* page_table = new PageTable{};
+        // page numbers of pages allocated in page table, so that releasing need not walk the whole page table
+        mutable std::set<uint64_t> allocated_pages;
+        mutable TLB tlb;
+#ifdef CAMI_AM_FLAT_HEAP
+        static constexpr uint64_t FLAT_SEGMENT_SIZE = CAMI_MEMORY_HEAP_FLAT_SEGMENT_SIZE;
+        static_assert(FLAT_SEGMENT_SIZE % PAGE_SIZE == 0 && FLAT_SEGMENT_SIZE <= layout::HEAP_BOUNDARY - layout::HEAP_BASE);
+        // heap address in [HEAP_BASE, HEAP_BASE + FLAT_SEGMENT_SIZE) is mapped to host memory by a constant offset,
+        //   and the page table only serves the rest. nullptr if reservation failed, then page table serves all
+        uint8_t* flat_segment = reserveFlatSegment();
+        // offset from the beginning of flat segment, beyond which memory has never been written
+        uint64_t flat_segment_used = 0;
+        // free memory of flat segment is returned to OS only if its size is not less than `FLAT_RELEASE_THRESHOLD`,
+        //   since touching released memory again costs page faults
+        static constexpr uint64_t FLAT_RELEASE_THRESHOLD = 1_M;
+
+        static uint8_t* reserveFlatSegment() noexcept;
+#endif
+
+        ~Heap();
 
         static void deletePageTable(PageTable* table, int level) // NOLINT
         {
@@ -99,6 +156,38 @@ class VirtualMemory
         }
     };
 
+    struct Stack
+    {
+        static constexpr uint64_t MAX_SIZE = CAMI_MEMORY_STACK_MAX_SIZE;
+        // stack memory is committed in units of `GRANULARITY`
+        static constexpr uint64_t GRANULARITY = 64_K;
+        // unused stack memory is released only if its size is not less than `RELEASE_THRESHOLD`
+        static constexpr uint64_t RELEASE_THRESHOLD = 1_M;
+        // `MAX_SIZE` bytes of address space are reserved, the end of which corresponds to `layout::STACK_BOUNDARY`,
+        //   i.e. virtual address `addr` is mapped to host address `top - (layout::STACK_BOUNDARY - addr)`
+        uint8_t* top;
+        // size of valid stack segment(i.e. the maximum stack size ever used)
+        uint64_t size = 0;
+        uint64_t committed = 0;
+        // size of stack memory that may be backed by physical memory
+        uint64_t resident = 0;
+        // stack size at last notification
+        uint64_t last_used = 0;
+
+        Stack();
+        ~Stack();
+        Stack(const Stack&) = delete;
+        Stack& operator=(const Stack&) = delete;
+
+        [[nodiscard]] uint8_t* hostAddress(uint64_t addr) const noexcept
+        {
+            return this->top - (layout::STACK_BOUNDARY - addr);
+        }
+
+        void commit(uint64_t new_size);
+        void release(uint64_t used_size);
+    };
+
     struct MMIO
     {
         static constexpr uint64_t FILE_DESCRIPTOR_MAX = CAMI_MEMORY_MMIO_MAX_FILE;
@@ -131,7 +220,7 @@ class VirtualMemory
     lib::Array<uint8_t> code;
     lib::Array<uint8_t> data;
     const uint64_t string_literal_end;
-    std::deque<uint8_t> stack;
+    Stack stack;
     Heap heap;
     MMIO mmio;
 
@@ -156,6 +245,27 @@ public:
     void write(uint64_t addr, const uint8_t* src, uint64_t len);
     void zeroize(uint64_t addr, uint64_t len);
     void notifyStackPointer(uint64_t val);
+    // memory of heap pages lying entirely in [addr, addr + len) may be returned to OS,
+    //   content of which is unspecified afterwards(zero if returned)
+    void releaseHeap(uint64_t addr, uint64_t len);
+    // host memory backing [addr, addr + len) which stays valid(and writable) as long as the range is in use,
+    //   nullptr if the range must be accessed via `read`/`write`, e.g. string literal, MMIO, paged heap, unaligned range
+    [[nodiscard]] uint8_t* hostAddress(uint64_t addr, uint64_t len, uint64_t align);
+
+    // (hit count, miss count) of heap TLB
+    [[nodiscard]] std::pair<uint64_t, uint64_t> heapTLBStatistics() const noexcept
+    {
+        return {this->heap.tlb.hit_cnt, this->heap.tlb.miss_cnt};
+    }
+
+    [[nodiscard]] bool usesFlatHeapSegment() const noexcept
+    {
+#ifdef CAMI_AM_FLAT_HEAP
+        return this->heap.flat_segment != nullptr;
+#else
+        return false;
+#endif
+    }
 
     [[nodiscard]] uint8_t read8(uint64_t addr) const
     {
@@ -290,7 +400,7 @@ public:
 
     [[nodiscard]] bool inValidStackSegment(uint64_t addr) const noexcept
     {
-        return addr < layout::STACK_BOUNDARY && addr >= layout::STACK_BOUNDARY - this->stack.size();
+        return addr < layout::STACK_BOUNDARY && addr >= layout::STACK_BOUNDARY - this->stack.size;
     }
 
     static bool inValidHeapSegment(uint64_t addr) noexcept
@@ -318,7 +428,7 @@ public:
     [[nodiscard]] bool inValidStackSegment(uint64_t addr, uint64_t len) const noexcept
     {
         ASSERT(addr + len >= addr, "too large length");
-        return addr + len <= layout::STACK_BOUNDARY && addr >= layout::STACK_BOUNDARY - this->stack.size();
+        return addr + len <= layout::STACK_BOUNDARY && addr >= layout::STACK_BOUNDARY - this->stack.size;
     }
 
     static bool inValidHeapSegment(uint64_t addr, uint64_t len) noexcept
@@ -337,6 +447,26 @@ private:
     void readCode(uint8_t* dest, uint64_t addr, uint64_t len) const;
     void readData(uint8_t* dest, uint64_t addr, uint64_t len) const;
     void readStack(uint8_t* dest, uint64_t addr, uint64_t len) const;
+#ifdef CAMI_AM_FLAT_HEAP
+    // return host address if [addr, addr + len) lies in flat heap segment, nullptr otherwise
+    [[nodiscard]] uint8_t* flatHeapAddress(uint64_t addr, uint64_t len) const noexcept
+    {
+        if (this->heap.flat_segment != nullptr && addr - layout::HEAP_BASE + len <= Heap::FLAT_SEGMENT_SIZE) {
+            return this->heap.flat_segment + (addr - layout::HEAP_BASE);
+        }
+        return nullptr;
+    }
+
+    // same as `flatHeapAddress`, but the range is going to be written
+    [[nodiscard]] uint8_t* flatHeapAddressForWrite(uint64_t addr, uint64_t len) noexcept
+    {
+        auto* host = this->flatHeapAddress(addr, len);
+        if (host != nullptr && addr - layout::HEAP_BASE + len > this->heap.flat_segment_used) {
+            this->heap.flat_segment_used = addr - layout::HEAP_BASE + len;
+        }
+        return host;
+    }
+#endif
     void readHeap(uint8_t* dest, uint64_t addr, uint64_t len) const;
     void readMMIO(uint8_t* dest, uint64_t addr, uint64_t len) const;
     void writeData(uint64_t addr, const uint8_t* src, uint64_t len);
@@ -348,6 +478,8 @@ private:
     void writePage(uint64_t addr, const uint8_t* src, uint64_t len);
     void zeroizePage(uint64_t addr, uint64_t len);
     [[nodiscard]] lib::Optional<Heap::Page*> getPage(uint64_t addr) const;
+    [[nodiscard]] lib::Optional<Heap::Page*> walkPageTable(uint64_t addr) const;
+    void freePage(uint64_t page_number);
     [[nodiscard]] Heap::Page* allocPage(uint64_t addr) const;
     [[nodiscard]] uint64_t findAvailableFd() const;
     uint64_t do_open();
@@ -40,6 +40,11 @@ struct Argument
         struct
         {
             std::string_view file_name;
+            bool tiering_stats;
+            bool profile;
+            uint64_t sample_interval;
+            uint64_t rss_interval;
+            bool fold_constant;
         } run;
         struct
         {
@@ -298,8 +298,8 @@ public:
     const lib::Array<const Type*> members;
 
 protected:
-    Struct(std::string name, lib::Array<const Type*> members)
-            : name(std::move(name)), members(std::move(members))
+    Struct(std::string name, lib::Array<const Type*> members, const uint64_t& current_layout_generation)
+            : name(std::move(name)), members(std::move(members)), current_layout_generation(current_layout_generation)
     {
         ASSERT(std::all_of(this->members.begin(), this->members.end(), [](const Type* item) {
             return item->kind() != Kind::function && item->kind() < Kind::_value_tag;
@@ -313,8 +313,28 @@ public:
         return Kind::struct_;
     }
 
-    [[nodiscard]] size_t size() const noexcept override;
-    [[nodiscard]] size_t align() const noexcept override;
+    [[nodiscard]] size_t size() const noexcept override
+    {
+        this->computeLayout();
+        return this->size_;
+    }
+
+    [[nodiscard]] size_t align() const noexcept override
+    {
+        this->computeLayout();
+        return this->align_;
+    }
+
+    // offset of each member
+    [[nodiscard]] const lib::Array<size_t>& offsets() const noexcept
+    {
+        this->computeLayout();
+        return this->member_offsets;
+    }
+
+    // index of the first member ending after `offset` (i.e. the member containing the byte at `offset`,
+    //   or the one following the padding containing it), `members.length()` if there is no such member
+    [[nodiscard]] size_t memberIndexAt(size_t offset) const noexcept;
 
     [[nodiscard]] bool equals(const Type& that) const noexcept final
     {
@@ -325,6 +345,25 @@ public:
     {
         return std::hash<std::string>{}(this->name);
     }
+
+private:
+    // layout is computed on first use rather than on creation since member of struct/union type may be
+    //   (re)defined afterward, in which case `MemoryManager` bumps its layout generation
+    void computeLayout() const noexcept
+    {
+        if (this->layout_generation != this->current_layout_generation) {
+            this->doComputeLayout();
+        }
+    }
+
+    void doComputeLayout() const noexcept;
+
+    const uint64_t& current_layout_generation; // owned by `MemoryManager`, never zero
+    mutable uint64_t layout_generation = 0; // generation at which cached layout is computed, zero if not computed
+    mutable size_t size_ = 0;
+    mutable size_t align_ = 1;
+    mutable lib::Array<size_t> member_offsets{};
+    mutable lib::Array<size_t> member_ends{}; // `member_offsets[i] + members[i]->size()`, ascending
 };
 
 class Union : public Derived
@@ -102,6 +102,8 @@ class MemoryManager
     detail::TypePool<Struct> struct_area;
     detail::TypePool<Union> union_area;
     Basic* basic_area; // subarea of trivial_deconstructed_area, used for speeding up `getBasicType`
+    // bumped whenever a struct/union is (re)defined, which invalidates layouts cached by structs
+    uint64_t layout_generation = 1;
 public:
     MemoryManager();
 public:
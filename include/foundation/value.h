@@ -23,10 +23,14 @@
 #include <lib/optional.h>
 #include <lib/downcast.h>
 #include <lib/format.h>
+#include <algorithm>
+#include <new>
+#include <type_traits>
 
 namespace cami {
 class ValueBox;
 namespace am {
+class BinaryOperatorKernel;
 ValueBox operator+(ValueBox lhs, ValueBox rhs);
 ValueBox operator-(ValueBox lhs, ValueBox rhs);
 ValueBox operator*(ValueBox lhs, ValueBox rhs);
@@ -56,6 +60,7 @@ void operator^=(ValueBox& lhs, ValueBox rhs);
 }
 #define DECLARE_FRIEND                                        \
     friend class ValueBox;                                    \
+    friend class am::BinaryOperatorKernel;                    \
     friend ValueBox am::operator+(ValueBox lhs, ValueBox rhs);\
     friend ValueBox am::operator-(ValueBox lhs, ValueBox rhs);\
     friend ValueBox am::operator*(ValueBox lhs, ValueBox rhs);\
@@ -122,20 +127,20 @@ public:
     }
 
 private:
-    IntegerValue* operator~() const;
-    IntegerValue* operator-() const;
-    IntegerValue* operator+(IntegerValue* rhs) const;
-    IntegerValue* operator*(IntegerValue* rhs) const;
-    IntegerValue* operator/(IntegerValue* rhs) const;
-    IntegerValue* operator%(IntegerValue* rhs) const;
-    IntegerValue* operator<(IntegerValue* rhs) const;
-    IntegerValue* operator<=(IntegerValue* rhs) const;
-    IntegerValue* operator==(IntegerValue* rhs) const;
-    IntegerValue* operator&(IntegerValue* rhs) const;
-    IntegerValue* operator|(IntegerValue* rhs) const;
-    IntegerValue* operator^(IntegerValue* rhs) const;
-    IntegerValue* operator<<(IntegerValue* rhs) const;
-    IntegerValue* operator>>(IntegerValue* rhs) const;
+    IntegerValue operator~() const;
+    IntegerValue operator-() const;
+    IntegerValue operator+(IntegerValue* rhs) const;
+    IntegerValue operator*(IntegerValue* rhs) const;
+    IntegerValue operator/(IntegerValue* rhs) const;
+    IntegerValue operator%(IntegerValue* rhs) const;
+    IntegerValue operator<(IntegerValue* rhs) const;
+    IntegerValue operator<=(IntegerValue* rhs) const;
+    IntegerValue operator==(IntegerValue* rhs) const;
+    IntegerValue operator&(IntegerValue* rhs) const;
+    IntegerValue operator|(IntegerValue* rhs) const;
+    IntegerValue operator^(IntegerValue* rhs) const;
+    IntegerValue operator<<(IntegerValue* rhs) const;
+    IntegerValue operator>>(IntegerValue* rhs) const;
     IntegerValue* inplaceComplement();
     IntegerValue* inplaceNegation();
     void operator+=(IntegerValue* rhs);
@@ -180,13 +185,13 @@ public:
     }
 
 private:
-    F32Value* operator-() const;
-    F32Value* operator+(F32Value* rhs) const;
-    F32Value* operator*(F32Value* rhs) const;
-    F32Value* operator/(F32Value* rhs) const;
-    IntegerValue* operator<(F32Value* rhs) const;
-    IntegerValue* operator<=(F32Value* rhs) const;
-    IntegerValue* operator==(F32Value* rhs) const;
+    F32Value operator-() const;
+    F32Value operator+(F32Value* rhs) const;
+    F32Value operator*(F32Value* rhs) const;
+    F32Value operator/(F32Value* rhs) const;
+    IntegerValue operator<(F32Value* rhs) const;
+    IntegerValue operator<=(F32Value* rhs) const;
+    IntegerValue operator==(F32Value* rhs) const;
     F32Value* inplaceNegation();
     void operator+=(F32Value* rhs);
     void operator*=(F32Value* rhs);
@@ -216,13 +221,13 @@ public:
     }
 
 private:
-    F64Value* operator-() const;
-    F64Value* operator+(F64Value* rhs) const;
-    F64Value* operator*(F64Value* rhs) const;
-    F64Value* operator/(F64Value* rhs) const;
-    IntegerValue* operator<(F64Value* rhs) const;
-    IntegerValue* operator<=(F64Value* rhs) const;
-    IntegerValue* operator==(F64Value* rhs) const;
+    F64Value operator-() const;
+    F64Value operator+(F64Value* rhs) const;
+    F64Value operator*(F64Value* rhs) const;
+    F64Value operator/(F64Value* rhs) const;
+    IntegerValue operator<(F64Value* rhs) const;
+    IntegerValue operator<=(F64Value* rhs) const;
+    IntegerValue operator==(F64Value* rhs) const;
     F64Value* inplaceNegation();
     void operator+=(F64Value* rhs);
     void operator*=(F64Value* rhs);
@@ -252,8 +257,8 @@ public:
         ASSERT(this->checkInvariant(), "invalid param");
     }
 
-    IntegerValue* operator==(PointerValue* rhs) const;
-    IntegerValue* operator==(NullValue* rhs) const;
+    IntegerValue operator==(PointerValue* rhs) const;
+    IntegerValue operator==(NullValue* rhs) const;
     [[nodiscard]] bool isZero() const noexcept;
     [[nodiscard]] uint64_t getAddress() const noexcept;
 
@@ -308,8 +313,8 @@ class NullValue : public Value
 public:
     NullValue() : Value(&ts::type_manager.getBasicType(ts::Kind::null)) {}
 
-    IntegerValue* operator==(PointerValue* rhs) const;
-    IntegerValue* operator==(NullValue* rhs) const;
+    IntegerValue operator==(PointerValue* rhs) const;
+    IntegerValue operator==(NullValue* rhs) const;
 };
 
 class UndefinedValue : public Value
@@ -318,55 +323,45 @@ public:
     UndefinedValue() : Value(&ts::type_manager.getInvalid()) {}
 };
 
+// values are stored inline (rather than allocated on heap), so that copying, moving and destroying
+//   a ValueBox are just copying bytes
 class ValueBox
 {
-    Value* value;
+    static constexpr size_t storage_size = std::max({
+            sizeof(IntegerValue), sizeof(F32Value), sizeof(F64Value), sizeof(PointerValue),
+            sizeof(DissociativePointerValue), sizeof(StructOrUnionValue), sizeof(NullValue), sizeof(UndefinedValue)});
+    static constexpr size_t storage_align = std::max({
+            alignof(IntegerValue), alignof(F32Value), alignof(F64Value), alignof(PointerValue),
+            alignof(DissociativePointerValue), alignof(StructOrUnionValue), alignof(NullValue), alignof(UndefinedValue)});
+
+    // `mutable` because operations on value through a const ValueBox are allowed, same as when
+    //   values were referenced by pointer
+    alignas(storage_align) mutable unsigned char storage[storage_size];
+
+    friend class am::BinaryOperatorKernel;
 public:
-    explicit ValueBox(Value* value) : value(value) {}
-
-    ValueBox(ValueBox&& that) noexcept : value(std::exchange(that.value, nullptr)) {};
-
-    ValueBox& operator=(ValueBox&& that) noexcept
-    {
-        if (&that != this) [[likely]] {
-            this->~ValueBox();
-            this->value = that.value;
-            that.value = nullptr;
-        }
-        return *this;
-    }
-
-    ValueBox(const ValueBox& that) : value(ValueBox::copy(that.value)) {}
-
-    ValueBox& operator=(const ValueBox& that)
-    {
-        if (this != &that) [[likely]] {
-            this->~ValueBox();
-            this->value = ValueBox::copy(that.value);
-        }
-        return *this;
-    }
-
-    ~ValueBox()
+    template<typename T, typename = std::enable_if_t<std::is_base_of_v<Value, T>>>
+    explicit ValueBox(const T& value)
     {
-        if (this->value != nullptr) {
-            ValueBox::delete_(this->value);
-        }
+        new(this->storage) T{value};
     }
 
 public:
     // convert arithmetic types only
     void castTo(const ts::Type& type);
+    // same as `castTo(type)` with kinds of value and `type` known ahead, i.e. `from` and `to`
+    template<ts::Kind from, ts::Kind to>
+    void castTo(const ts::Type& type);
     ValueBox cast(const ts::Type& type);
 
     Value& operator*() const noexcept
     {
-        return *this->value;
+        return *this->value();
     }
 
     Value* operator->() const noexcept
     {
-        return this->value;
+        return this->value();
     }
 
     ValueBox operator+() const;
@@ -380,42 +375,42 @@ public:
 
     explicit operator Value*() const noexcept
     {
-        return this->value;
+        return this->value();
     }
 
     explicit operator IntegerValue*() const noexcept
     {
-        return down_cast<IntegerValue*>(this->value);
+        return down_cast<IntegerValue*>(this->value());
     }
 
     explicit operator F32Value*() const noexcept
     {
-        return down_cast<F32Value*>(this->value);
+        return down_cast<F32Value*>(this->value());
     }
 
     explicit operator F64Value*() const noexcept
     {
-        return down_cast<F64Value*>(this->value);
+        return down_cast<F64Value*>(this->value());
     }
 
     explicit operator PointerValue*() const noexcept
     {
-        return down_cast<PointerValue*>(this->value);
+        return down_cast<PointerValue*>(this->value());
     }
 
     explicit operator DissociativePointerValue*() const noexcept
     {
-        return down_cast<DissociativePointerValue*>(this->value);
+        return down_cast<DissociativePointerValue*>(this->value());
     }
 
     explicit operator StructOrUnionValue*() const noexcept
     {
-        return down_cast<StructOrUnionValue*>(this->value);
+        return down_cast<StructOrUnionValue*>(this->value());
     }
 
     explicit operator NullValue*() const noexcept
     {
-        return down_cast<NullValue*>(this->value);
+        return down_cast<NullValue*>(this->value());
     }
 
     template<typename T>
@@ -425,19 +420,35 @@ public:
     }
 
 private:
+    [[nodiscard]] Value* value() const noexcept
+    {
+        return std::launder(reinterpret_cast<Value*>(this->storage));
+    }
+
+    // replace current value with a new one of (maybe) different kind
+    // the new value is constructed before the old one is overwritten, hence `args` may refer to the old one
+    template<typename T, typename ...ARGS>
+    void emplace(ARGS&& ... args)
+    {
+        T tmp{std::forward<ARGS>(args)...};
+        new(this->storage) T{tmp};
+    }
+
     static void integerPromote(Value* v);
     static void toFloat_uac(ValueBox& lhs, ValueBox& rhs);
-    static void delete_(Value* value);
-    static Value* copy(Value* value);
 public:
     static void integerPromote(const ValueBox& vb)
     {
-        integerPromote(vb.value);
+        integerPromote(vb.value());
     }
 
     static void usualArithmeticConvert(ValueBox& lhs, ValueBox& rhs);
 };
 
+#ifdef NDEBUG
+static_assert(std::is_trivially_copyable_v<ValueBox>);
+#endif
+
 } // namespace cami
 
 #undef DECLARE_FRIEND
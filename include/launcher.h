@@ -30,13 +30,25 @@ enum class FileType
     text, binary, detect
 };
 
+struct LaunchOption
+{
+    bool tiering_stats = false;
+    bool profile = false;
+    uint64_t sample_interval = 0; // 0 means disabling sampling profiler
+    uint64_t rss_interval = 0; // 0 means disabling memory sampler
+    bool fold_constant = true; // fold constant subexpressions when linking object files
+};
+
 class Launcher
 {
 public:
-    static void launch(std::string_view file_name, FileType file_type = FileType::detect);
+    static void launch(std::string_view file_name, const LaunchOption& option = {},
+                       FileType file_type = FileType::detect);
+    static std::unique_ptr<tr::LinkedMBC> load(std::string_view file_name, FileType file_type = FileType::detect,
+                                               bool fold_constant = true);
 private:
     static std::unique_ptr<tr::MBC> loadFile(std::string_view file_name, bool text_file);
-    static std::unique_ptr<tr::LinkedMBC> linkFile(std::unique_ptr<tr::UnlinkedMBC> mbc);
+    static std::unique_ptr<tr::LinkedMBC> linkFile(std::unique_ptr<tr::UnlinkedMBC> mbc, bool fold_constant);
     static FileType detectFileType(std::string_view file_name);
 };
 
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef CAMI_LIB_OVERFLOW_H
+#define CAMI_LIB_OVERFLOW_H
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// checked integer arithmetic
+// each function stores the wrapped result to `*res` and returns whether the mathematical result is not
+//   representable in `T`, i.e. it behaves like `__builtin_*_overflow` with all three types being `T`
+namespace cami::lib {
+
+template<typename T>
+inline bool addOverflow(T a, T b, T* res) noexcept
+{
+    static_assert(std::is_integral_v<T>);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_add_overflow(a, b, res);
+#else
+    using U = std::make_unsigned_t<T>;
+    *res = static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+    if constexpr (std::is_unsigned_v<T>) {
+        return *res < a;
+    } else {
+        // overflow iff both operands have the same sign which differs from the sign of result
+        return static_cast<T>((a ^ *res) & (b ^ *res)) < 0;
+    }
+#endif
+}
+
+template<typename T>
+inline bool subOverflow(T a, T b, T* res) noexcept
+{
+    static_assert(std::is_integral_v<T>);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_sub_overflow(a, b, res);
+#else
+    using U = std::make_unsigned_t<T>;
+    *res = static_cast<T>(static_cast<U>(a) - static_cast<U>(b));
+    if constexpr (std::is_unsigned_v<T>) {
+        return a < b;
+    } else {
+        return static_cast<T>((a ^ b) & (a ^ *res)) < 0;
+    }
+#endif
+}
+
+template<typename T>
+inline bool mulOverflow(T a, T b, T* res) noexcept
+{
+    static_assert(std::is_integral_v<T>);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_mul_overflow(a, b, res);
+#else
+    using U = std::make_unsigned_t<T>;
+    if constexpr (sizeof(T) < sizeof(int64_t)) {
+        // the product of two narrower integers always fits in 64 bits
+        using Wide = std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>;
+        auto product = static_cast<Wide>(a) * static_cast<Wide>(b);
+        *res = static_cast<T>(product);
+        return product < static_cast<Wide>(std::numeric_limits<T>::min()) ||
+               product > static_cast<Wide>(std::numeric_limits<T>::max());
+    } else if constexpr (std::is_unsigned_v<T>) {
+        *res = a * b;
+        return a != 0 && *res / a != b;
+    } else {
+        *res = static_cast<T>(static_cast<U>(a) * static_cast<U>(b));
+        if (a == 0 || b == 0) {
+            return false;
+        }
+        if (a == -1) {
+            return b == std::numeric_limits<T>::min();
+        }
+        if (b == -1) {
+            return a == std::numeric_limits<T>::min();
+        }
+        return *res / b != a;
+    }
+#endif
+}
+
+} // namespace cami::lib
+
+#endif //CAMI_LIB_OVERFLOW_H
@@ -0,0 +1,44 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef CAMI_TRANSLATE_CONSTANT_FOLDER_H
+#define CAMI_TRANSLATE_CONSTANT_FOLDER_H
+
+#include "bytecode.h"
+
+namespace cami::tr {
+
+// ConstantFolder rewrites the code of each function of unlinked bytecode before relocation:
+//   + `push c1; push c2; <binary operator>` becomes `push c`
+//   + `push c1; <unary operator>` and `push c1; cast T`(T is arithmetic type) become `push c`
+// where constants are of arithmetic type and `c` is a new entry of constant pool. Folding is
+//   repeated on its own results, so that a whole constant subexpression collapses into one `push`.
+// Operations are evaluated by the same routines abstract machine uses, and an operation whose
+//   evaluation would raise any exception(e.g. UB of overflow or division by zero) is kept
+//   as is, so that it still traps at run time. Instructions which are jump targets are never
+//   merged into the preceding ones, and functions containing `ij` are left untouched since
+//   their jump targets are not known statically.
+class ConstantFolder
+{
+public:
+    static void fold(UnlinkedMBC& bytecode);
+private:
+    static bool foldFunction(UnlinkedMBC& bytecode, UnlinkedMBC::Function& func);
+};
+
+} // namespace cami::tr
+
+#endif //CAMI_TRANSLATE_CONSTANT_FOLDER_H
@@ -24,6 +24,7 @@ namespace cami::tr {
 struct LinkOption
 {
     MBC::Type type;
+    bool fold_constant = true; // see `ConstantFolder`, turned off for differential testing
 };
 
 class Linker
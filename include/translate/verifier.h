@@ -0,0 +1,46 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef CAMI_TRANSLATE_VERIFIER_H
+#define CAMI_TRANSLATE_VERIFIER_H
+
+#include "bytecode.h"
+
+namespace cami::tr {
+
+// Verifier statically proves what compiler should guarantee for the code of each function of linked bytecode:
+//   + every instruction is valid, and the code does not fall through the end of function
+//   + identifiers, constants, types, blocks and full expressions referenced by instructions are in range
+//   + all jump targets are instruction boundaries of the same function
+//   + operand stack never underflows, its depth is consistent at every merge point, and
+//       exactly the return value(if any) is left on it when `ret` is executed
+//   + `eb` and `lb` are well nested
+// Functions that pass are marked `verified`, and the abstract machine executes them without
+//   re-checking these properties at runtime. Functions containing indirect call(i.e. callee is
+//   not known statically) or `ij` are never verified.
+class Verifier
+{
+public:
+    static void verify(LinkedMBC& bytecode);
+private:
+    // verify code of `func` executed within the frame of `frame`, i.e. blocks, automatic objects and
+    //   full expressions referenced by the code are those of `frame`
+    static bool verifyFunction(const LinkedMBC& bytecode, const am::spd::Function& func, const am::spd::Function& frame);
+};
+
+} // namespace cami::tr
+
+#endif //CAMI_TRANSLATE_VERIFIER_H
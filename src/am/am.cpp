@@ -20,6 +20,8 @@
 #include <exception.h>
 #include <iostream>
 #include <numeric>
+#include <tuple>
+#include <algorithm>
 #include <foundation/type/helper.h>
 #include <foundation/logger.h>
 #include <lib/utils.h>
@@ -30,8 +32,47 @@ using namespace am::spd;
 
 AbstractMachine::ExitCode AbstractMachine::run()
 {
+    NullMonitor monitor;
+    return this->do_run(monitor);
+}
+
+AbstractMachine::ExitCode AbstractMachine::run(OpcodeHistogram& histogram)
+{
+    return this->do_run(histogram);
+}
+
+AbstractMachine::ExitCode AbstractMachine::run(OpcodeProfiler& profiler)
+{
+    auto exit_code = this->do_run(profiler);
+    profiler.stop();
+    return exit_code;
+}
+
+AbstractMachine::ExitCode AbstractMachine::run(SamplingProfiler& profiler)
+{
+    return this->do_run(profiler);
+}
+
+AbstractMachine::ExitCode AbstractMachine::run(MemorySampler& sampler)
+{
+    return this->do_run(sampler);
+}
+
+template<typename Monitor>
+AbstractMachine::ExitCode AbstractMachine::do_run(Monitor& monitor)
+{
+#ifdef CAMI_AM_JIT
+    if constexpr (Monitor::allow_jit) {
+        this->jit.init(*this);
+    }
+#endif
+#ifdef CAMI_ENABLE_SUPERINSTRUCTION
+    if constexpr (Monitor::allow_superinstruction) {
+        FetchDecode::fuse(*this);
+    }
+#endif
     try {
-        this->execute();
+        this->execute(monitor);
     } catch (const ObjectStorageOutOfMemoryException& e) {
         log::unbuffered.eprintln(e.what());
         return ExitCode::abort;
@@ -42,112 +83,313 @@ AbstractMachine::ExitCode AbstractMachine::run()
     return ExitCode::halt;
 }
 
-void AbstractMachine::execute()
+#if defined(CAMI_ENABLE_THREADED_DISPATCH) && defined(__GNUC__)
+#define CAMI_AM_THREADED_DISPATCH
+#endif
+
+template<typename Monitor>
+void AbstractMachine::execute(Monitor& monitor)
 {
     while (true) {
-        const auto [op, extraInfo] = FetchDecode::decode(*this);
-//        log::unbuffered.dprintln("${}", op);
+#ifdef CAMI_AM_JIT
+        if constexpr (Monitor::allow_jit) {
+            if (this->jit.enter(*this)) {
+                continue;
+            }
+        }
+#endif
+        if (!(this->state.current_function().static_info->verified ? this->do_execute<true>(monitor)
+                                                                    : this->do_execute<false>(monitor))) {
+            return;
+        }
+    }
+}
+
+template<bool verified, typename Monitor>
+bool AbstractMachine::shouldSwitchExecutionMode() noexcept
+{
+#ifdef CAMI_AM_JIT
+    if constexpr (Monitor::allow_jit) {
+        if (this->jit.hasNativeCode(this->state.pc)) {
+            return true;
+        }
+    }
+#endif
+    return this->state.current_function().static_info->verified != verified;
+}
+
+template<bool verified, typename Monitor>
+bool AbstractMachine::do_execute(Monitor& monitor)
+{
+    Opcode op;
+    InstrInfo extra_info{};
+    // leave current loop to switch to handlers of the other variant or native code if needed
+#define CHECK_EXECUTION_MODE()                                           \
+    do {                                                                \
+        if (this->shouldSwitchExecutionMode<verified, Monitor>()) {     \
+            return true;                                                \
+        }                                                               \
+    } while (false)
+#ifdef CAMI_AM_JIT
+    // count taken backward jumps and calls for tiering, see `JIT`
+#define COUNT_BACKWARD_JUMP(next_pc)                                                            \
+    do {                                                                                        \
+        if constexpr (Monitor::allow_jit) {                                                     \
+            if (this->state.pc < (next_pc) && this->jit.onBackwardJump(*this, (next_pc))) {     \
+                return true;                                                                    \
+            }                                                                                   \
+        }                                                                                       \
+    } while (false)
+#define COUNT_CALL()                                                                            \
+    do {                                                                                        \
+        if constexpr (Monitor::allow_jit) {                                                     \
+            this->jit.onCall(*this);                                                            \
+        }                                                                                       \
+    } while (false)
+#else
+#define COUNT_BACKWARD_JUMP(next_pc) static_cast<void>(next_pc)
+#define COUNT_CALL() static_cast<void>(0)
+#endif
+#ifdef CAMI_AM_THREADED_DISPATCH
+    // direct-threaded dispatch: each handler jumps to the next one by itself, so that the host CPU
+    //   can predict every indirect jump separately
+    // the table is filled only once for each instantiation
+    static const void* dispatch_table[256];
+    static bool dispatch_table_initialized = false;
+    if (!dispatch_table_initialized) {
+        dispatch_table_initialized = true;
+        std::fill(std::begin(dispatch_table), std::end(dispatch_table), &&label_default);
+#define SET_DISPATCH_LABEL(name) dispatch_table[static_cast<uint8_t>(Opcode::name)] = &&label_##name
+        SET_DISPATCH_LABEL(nop);
+        SET_DISPATCH_LABEL(halt);
+        SET_DISPATCH_LABEL(dsg);
+        SET_DISPATCH_LABEL(drf);
+        SET_DISPATCH_LABEL(read);
+        SET_DISPATCH_LABEL(mdf);
+        SET_DISPATCH_LABEL(zero);
+        SET_DISPATCH_LABEL(mdfi);
+        SET_DISPATCH_LABEL(zeroi);
+        SET_DISPATCH_LABEL(eb);
+        SET_DISPATCH_LABEL(lb);
+        SET_DISPATCH_LABEL(new_);
+        SET_DISPATCH_LABEL(del);
+        SET_DISPATCH_LABEL(fe);
+        SET_DISPATCH_LABEL(j);
+        SET_DISPATCH_LABEL(jst);
+        SET_DISPATCH_LABEL(jnt);
+        SET_DISPATCH_LABEL(call);
+        SET_DISPATCH_LABEL(ij);
+        SET_DISPATCH_LABEL(ret);
+        SET_DISPATCH_LABEL(pushu);
+        SET_DISPATCH_LABEL(push);
+        SET_DISPATCH_LABEL(pop);
+        SET_DISPATCH_LABEL(dup);
+        SET_DISPATCH_LABEL(dot);
+        SET_DISPATCH_LABEL(arrow);
+        SET_DISPATCH_LABEL(addr);
+        SET_DISPATCH_LABEL(cast);
+        SET_DISPATCH_LABEL(fe_dsg);
+        SET_DISPATCH_LABEL(dsg_read);
+        SET_DISPATCH_LABEL(dsg_addr);
+        SET_DISPATCH_LABEL(dsg_mdf);
+        SET_DISPATCH_LABEL(push_add);
+        SET_DISPATCH_LABEL(push_cast);
+        SET_DISPATCH_LABEL(fe_dsg_read);
+        SET_DISPATCH_LABEL(dsg_addr_call);
+#undef SET_DISPATCH_LABEL
+        for (auto i = static_cast<uint8_t>(Opcode::cpl); i <= static_cast<uint8_t>(Opcode::not_); ++i) {
+            dispatch_table[i] = &&label_unary_operator;
+        }
+        for (auto i = static_cast<uint8_t>(Opcode::mul); i <= static_cast<uint8_t>(Opcode::xor_); ++i) {
+            dispatch_table[i] = &&label_binary_operator;
+        }
+    }
+#define CASE(name) label_##name
+#define CASE_DEFAULT label_default
+#define CASE_UNARY_OPERATOR label_unary_operator
+#define CASE_BINARY_OPERATOR label_binary_operator
+#define NEXT()                                                     \
+    do {                                                           \
+        std::tie(op, extra_info) = FetchDecode::decode(*this);     \
+        monitor.onDispatch(op, this->state, this->operand_stack);  \
+        goto* dispatch_table[static_cast<uint8_t>(op)];            \
+    } while (false)
+    NEXT();
+#else
+#define CASE(name) case Opcode::name
+#define CASE_DEFAULT default
+#define NEXT() break
+    while (true) {
+        std::tie(op, extra_info) = FetchDecode::decode(*this);
+        monitor.onDispatch(op, this->state, this->operand_stack);
         switch (op) {
-        case Opcode::nop:
-            break;
-        case Opcode::halt:
+#endif
+//        log::unbuffered.dprintln("${}", op);
+        CASE(nop):
+            NEXT();
+        CASE(halt):
             if (this->operand_stack.getStack().empty()) {
                 log::buffered.iprintln("Abstract machine halt with no return code");
-                return;
+                return false;
             }
             {
                 auto rv = this->operand_stack.pop();
                 if (rv.attr.indeterminate) {
                     log::buffered.iprintln("Abstract machine halt with indeterminate value");
-                    return;
+                    return false;
                 }
                 if (!isInteger(rv.vb->getType().kind())) {
                     log::buffered.iprintln("Abstract machine halt with non-integer value ${}", rv.vb);
-                    return;
+                    return false;
                 }
                 auto val = rv.vb.get<IntegerValue>().uint64();
                 log::buffered.iprintln("Abstract machine halt with return code ${}", *reinterpret_cast<int64_t*>(&val));
             }
-            return;
-        case Opcode::dsg:
-            Execute::designate(*this, extraInfo);
-            break;
-        case Opcode::drf:
+            return false;
+        CASE(dsg):
+            Execute::designate<verified>(*this, extra_info);
+            NEXT();
+        CASE(drf):
             Execute::dereference(*this);
-            break;
-        case Opcode::read:
-            Execute::read(*this, extraInfo);
-            break;
-        case Opcode::mdf:
-            Execute::modify(*this, extraInfo);
-            break;
-        case Opcode::zero:
-            Execute::zero(*this, extraInfo);
-            break;
-        case Opcode::mdfi:
+            NEXT();
+        CASE(read):
+            Execute::read(*this, extra_info);
+            NEXT();
+        CASE(mdf):
+            Execute::modify(*this, extra_info);
+            NEXT();
+        CASE(zero):
+            Execute::zero(*this, extra_info);
+            NEXT();
+        CASE(mdfi):
             Execute::writeInit(*this);
-            break;
-        case Opcode::zeroi:
+            NEXT();
+        CASE(zeroi):
             Execute::zeroInit(*this);
-            break;
-        case Opcode::eb:
-            Execute::enterBlock(*this, extraInfo);
-            break;
-        case Opcode::lb:
-            Execute::leaveBlock(*this);
-            break;
-        case Opcode::new_:
-            Execute::newObject(*this, extraInfo);
-            break;
-        case Opcode::del:
-            Execute::deleteObject(*this, extraInfo);
-            break;
-        case Opcode::fe:
-            Execute::fullExpression(*this, extraInfo);
-            break;
-        case Opcode::j:
-            Execute::jump(*this, extraInfo);
-            break;
-        case Opcode::jst:
-            Execute::jumpIfSet(*this, extraInfo);
-            break;
-        case Opcode::jnt:
-            Execute::jumpIfNotSet(*this, extraInfo);
-            break;
-        case Opcode::call:
-            Execute::call(*this, extraInfo);
-            break;
-        case Opcode::ij:
+            NEXT();
+        CASE(eb):
+            Execute::enterBlock<verified>(*this, extra_info);
+            NEXT();
+        CASE(lb):
+            Execute::leaveBlock<verified>(*this);
+            NEXT();
+        CASE(new_):
+            Execute::newObject<verified>(*this, extra_info);
+            NEXT();
+        CASE(del):
+            Execute::deleteObject(*this, extra_info);
+            NEXT();
+        CASE(fe):
+            Execute::fullExpression(*this, extra_info);
+            NEXT();
+        CASE(j): {
+            auto next_pc = this->state.pc;
+            Execute::jump<verified>(*this, extra_info);
+            COUNT_BACKWARD_JUMP(next_pc);
+        }
+            NEXT();
+        CASE(jst): {
+            auto next_pc = this->state.pc;
+            Execute::jumpIfSet<verified>(*this, extra_info);
+            COUNT_BACKWARD_JUMP(next_pc);
+        }
+            NEXT();
+        CASE(jnt): {
+            auto next_pc = this->state.pc;
+            Execute::jumpIfNotSet<verified>(*this, extra_info);
+            COUNT_BACKWARD_JUMP(next_pc);
+        }
+            NEXT();
+        CASE(call):
+            Execute::call(*this, extra_info);
+            COUNT_CALL();
+            CHECK_EXECUTION_MODE();
+            NEXT();
+        CASE(ij):
             Execute::indirectJump(*this);
-            break;
-        case Opcode::ret:
+            NEXT();
+        CASE(ret):
             Execute::ret(*this);
-            break;
-        case Opcode::pushu:
+            CHECK_EXECUTION_MODE();
+            NEXT();
+        CASE(pushu):
             Execute::pushUndefined(*this);
-            break;
-        case Opcode::push:
-            Execute::push(*this, extraInfo);
-            break;
-        case Opcode::pop:
+            NEXT();
+        CASE(push):
+            Execute::push<verified>(*this, extra_info);
+            NEXT();
+        CASE(pop):
             Execute::pop(*this);
-            break;
-        case Opcode::dup:
+            NEXT();
+        CASE(dup):
             Execute::duplicate(*this);
-            break;
-        case Opcode::dot:
-            Execute::dot(*this, extraInfo);
-            break;
-        case Opcode::arrow:
-            Execute::arrow(*this, extraInfo);
-            break;
-        case Opcode::addr:
+            NEXT();
+        CASE(dot):
+            Execute::dot(*this, extra_info);
+            NEXT();
+        CASE(arrow):
+            Execute::arrow(*this, extra_info);
+            NEXT();
+        CASE(addr):
+            Execute::address(*this);
+            NEXT();
+        CASE(cast):
+            Execute::cast<verified>(*this, extra_info);
+            NEXT();
+        // superinstructions execute each of its components in order (including updating pc),
+        //   so that all checks and trace events are the same as executing the components separately
+        CASE(fe_dsg):
+            Execute::fullExpression(*this, extra_info);
+            Execute::designate<verified>(*this, FetchDecode::decodeFollowing(*this));
+            NEXT();
+        CASE(dsg_read):
+            Execute::designate<verified>(*this, extra_info);
+            Execute::read(*this, FetchDecode::decodeFollowing(*this));
+            NEXT();
+        CASE(dsg_addr):
+            Execute::designate<verified>(*this, extra_info);
+            FetchDecode::decodeFollowing(*this);
+            Execute::address(*this);
+            NEXT();
+        CASE(dsg_mdf):
+            Execute::designate<verified>(*this, extra_info);
+            Execute::modify(*this, FetchDecode::decodeFollowing(*this));
+            NEXT();
+        CASE(push_add):
+            Execute::push<verified>(*this, extra_info);
+            FetchDecode::decodeFollowing(*this);
+            Execute::binaryOperator(*this, Opcode::add);
+            NEXT();
+        CASE(push_cast):
+            Execute::push<verified>(*this, extra_info);
+            Execute::cast<verified>(*this, FetchDecode::decodeFollowing(*this));
+            NEXT();
+        CASE(fe_dsg_read):
+            Execute::fullExpression(*this, extra_info);
+            Execute::designate<verified>(*this, FetchDecode::decodeFollowing(*this));
+            Execute::read(*this, FetchDecode::decodeFollowing(*this));
+            NEXT();
+        CASE(dsg_addr_call):
+            Execute::designate<verified>(*this, extra_info);
+            FetchDecode::decodeFollowing(*this);
             Execute::address(*this);
-            break;
-        case Opcode::cast:
-            Execute::cast(*this, extraInfo);
-            break;
-        default:
+            Execute::call(*this, FetchDecode::decodeFollowing(*this));
+            COUNT_CALL();
+            CHECK_EXECUTION_MODE();
+            NEXT();
+#ifdef CAMI_AM_THREADED_DISPATCH
+        CASE_UNARY_OPERATOR:
+            Execute::unaryOperator(*this, op);
+            NEXT();
+        CASE_BINARY_OPERATOR:
+            Execute::binaryOperator(*this, op);
+            NEXT();
+        CASE_DEFAULT:
+            throw InvalidOpcodeException{static_cast<uint8_t>(op)};
+#undef CASE_UNARY_OPERATOR
+#undef CASE_BINARY_OPERATOR
+#else
+        CASE_DEFAULT:
             if (FetchDecode::isUnaryOperator(op)) {
                 Execute::unaryOperator(*this, op);
             } else if (FetchDecode::isBinaryOperator(op)) {
@@ -157,6 +399,33 @@ void AbstractMachine::execute()
             }
         }
     }
+#endif
+#undef CASE
+#undef CASE_DEFAULT
+#undef NEXT
+#undef CHECK_EXECUTION_MODE
+#undef COUNT_BACKWARD_JUMP
+#undef COUNT_CALL
+}
+
+template void AbstractMachine::execute(NullMonitor& monitor);
+
+template void AbstractMachine::execute(OpcodeHistogram& monitor);
+
+template void AbstractMachine::execute(OpcodeProfiler& monitor);
+
+template void AbstractMachine::execute(SamplingProfiler& monitor);
+
+template void AbstractMachine::execute(MemorySampler& monitor);
+
+std::string AbstractMachine::tieringReport(size_t top_n) const
+{
+#ifdef CAMI_AM_JIT
+    return this->jit.report(*this, top_n);
+#else
+    static_cast<void>(top_n);
+    return "JIT is not enabled, all functions are interpreted\n";
+#endif
 }
 
 Global AbstractMachine::initStaticInfo(tr::LinkedMBC& bytecode)
@@ -166,7 +435,11 @@ Global AbstractMachine::initStaticInfo(tr::LinkedMBC& bytecode)
         auto& sod = bytecode.static_objects[i];
         static_objects[i] = this->object_manager.newPermanent(std::move(sod.name), *sod.type, sod.address);
     }
-    return Global{std::move(static_objects), std::move(bytecode.constants), std::move(bytecode.types),
+    lib::Array<OperandStack::RichValue> constants(bytecode.constants.length());
+    for (size_t i = 0; i < constants.length(); ++i) {
+        constants.init(i, bytecode.constants[i], OperandStack::Attribute{});
+    }
+    return Global{std::move(static_objects), std::move(constants), std::move(bytecode.types),
                   std::move(bytecode.functions)};
 }
 
@@ -179,6 +452,45 @@ uint64_t AbstractMachine::countPermanentObject(tr::LinkedMBC& bytecode)
             });
 }
 
+lib::Array<am::MemberAccessCache> AbstractMachine::createMemberAccessCaches(lib::Array<DecodedInstr>& instructions)
+{
+    uint32_t cnt = 0;
+    for (auto& item: instructions) {
+        if (item.op == Opcode::dot || item.op == Opcode::arrow) {
+            item.cache_id = cnt++;
+        }
+    }
+    lib::Array<MemberAccessCache> caches(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        caches.init(i);
+    }
+    return caches;
+}
+
+lib::Array<am::CallSiteCache> AbstractMachine::createCallSiteCaches(lib::Array<DecodedInstr>& instructions)
+{
+    uint32_t cnt = 0;
+    for (auto& item: instructions) {
+        if (item.op == Opcode::call) {
+            item.cache_id = cnt++;
+        }
+    }
+    lib::Array<CallSiteCache> caches(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        caches.init(i);
+    }
+    return caches;
+}
+
+lib::Array<am::CastPlan> AbstractMachine::createCastPlans(const lib::Array<const ts::Type*>& types)
+{
+    lib::Array<CastPlan> plans(types.length());
+    for (size_t i = 0; i < types.length(); ++i) {
+        plans.init(i, Execute::createCastPlan(*types[i]));
+    }
+    return plans;
+}
+
 tr::LinkedMBC& AbstractMachine::preprocessBytecode(tr::LinkedMBC& bytecode)
 {
     AbstractMachine::checkMetadataCnt(bytecode);
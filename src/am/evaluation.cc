@@ -17,4 +17,5 @@
 #include "evaluation/cast.cc"
 #include "evaluation/raw_value_eval.cc"
 #include "evaluation/valuebox_eval.cc"
+#include "evaluation/binary_kernel.cc"
 #include "evaluation/am_eval.cc"
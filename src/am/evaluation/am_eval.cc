@@ -15,6 +15,7 @@
  ******************************************************************************/
 
 #include <execute.h>
+#include <binary_kernel.h>
 #include <lib/compiler_guarantee.h>
 #include <exception.h>
 #include <foundation/type/helper.h>
@@ -67,8 +68,28 @@ bool checkPointer(PointerValue& ptr)
     return false;
 }
 
-void pointerAdd(PointerValue& ptr, uint64_t offset_in_element)
+void pointerAdd(am::PointerArithmeticCache& cache, PointerValue& ptr, uint64_t offset_in_element)
 {
+    // fast path: `ptr` references an element of array object, and has been checked against type of the array
+    if (auto entity = ptr.getReferenced(); entity && (*entity)->effective_type.kind() != Kind::function) {
+        auto& obj = down_cast<Object&>(**entity);
+        if (obj.super_object) {
+            auto& array = **obj.super_object;
+            auto& item = cache.entry(&ptr.getType(), &array.effective_type);
+            if (item.pointer_type == &ptr.getType() && item.array_type == &array.effective_type) {
+                auto idx = (obj.address + ptr.getOffset() - array.address) / item.stride + offset_in_element;
+                if (idx < item.length) {
+                    ptr.set(array.sub_objects[idx], 0);
+                    return;
+                }
+                if (idx == item.length) {
+                    ptr.set(array.sub_objects[idx - 1], item.stride);
+                    return;
+                }
+                // out of boundary, reported below
+            }
+        }
+    }
     bool is_char = checkPointer(ptr);
     auto& obj = down_cast<Object&>(**ptr.getReferenced());
     auto& obj_type = removeQualify(obj.effective_type);
@@ -100,6 +121,7 @@ void pointerAdd(PointerValue& ptr, uint64_t offset_in_element)
     auto idx = (obj.address + ptr.getOffset() - (*super_obj)->address) / obj_size;
     idx += offset_in_element;
     auto array_len = down_cast<const Array&>(super_obj_type).len;
+    cache.entry(&ptr.getType(), &(*super_obj)->effective_type) = {&ptr.getType(), &(*super_obj)->effective_type, obj_size, array_len};
     if (idx > array_len) {
         throw UBException{{UB::ptr_addition_oob, UB::idx_oob}, lib::format(
                 "Pointer addition out of boundary\narray length = ${} pointed index = ${}", array_len, idx)};
@@ -121,7 +143,7 @@ ValueBox pointerDiff(PointerValue& lhs, PointerValue& rhs)
             throw UBException{{UB::ivd_ptr_subtraction}, lib::format(
                     "Two character pointers which are not reference same object are subtracted\n${}\n${}", lhs, rhs)};
         }
-        return ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i64), lhs.getAddress() - rhs.getAddress()}};
+        return ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i64), lhs.getAddress() - rhs.getAddress()}};
     }
     auto& lhs_obj = down_cast<Object&>(**lhs.getReferenced());
     auto& rhs_obj = down_cast<Object&>(**rhs.getReferenced());
@@ -138,7 +160,7 @@ ValueBox pointerDiff(PointerValue& lhs, PointerValue& rhs)
         }
         ASSERT(lhs.getOffset() == 0 || lhs.getOffset() == lhs_obj.size(), "invalid offset");
         ASSERT(rhs.getOffset() == 0 || rhs.getOffset() == lhs_obj.size(), "invalid offset");
-        return ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i64),
+        return ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i64),
                                          static_cast<uint64_t>(!lhs.getOffset() - !rhs.getOffset())}};
         // equivalent to (rhs.getOffset() - lhs.getOffset()) / lhs_obj_type.size()
     }
@@ -149,7 +171,7 @@ ValueBox pointerDiff(PointerValue& lhs, PointerValue& rhs)
     ASSERT(&lhs_obj.effective_type == &rhs_obj.effective_type, "two elements of the same array must have same type");
     auto ptr_diff = lhs.getAddress() - rhs.getAddress();
     auto res = *reinterpret_cast<int64_t*>(&ptr_diff) / static_cast<int64_t>(lhs_obj.size());
-    return ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i64), static_cast<uint64_t>(res)}};
+    return ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i64), static_cast<uint64_t>(res)}};
 }
 
 int pointerCmp(PointerValue& lhs, PointerValue& rhs)
@@ -197,12 +219,12 @@ void Execute::unaryOperator(AbstractMachine& am, Opcode op)
         COMPILER_GUARANTEE(isScalar(operand->getType().kind()),
                            lib::format("invalid type `${}` of !", operand->getType()));
         if (operand->getType().kind() == Kind::null) {
-            operand = ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i32), 1}};
+            operand = ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i32), 1}};
         } else if (operand->getType().kind() == Kind::pointer) {
-            operand = ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i32),
+            operand = ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i32),
                                                 !operand.get<PointerValue>().isZero()}};
         } else if (operand->getType().kind() == Kind::dissociative_pointer) {
-            operand = ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i32),
+            operand = ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i32),
                                                 operand.get<DissociativePointerValue>().address != 0}};
         } else {
             operand = !operand;
@@ -232,16 +254,20 @@ void Execute::binaryOperator(AbstractMachine& am, Opcode op)
     }
     auto& lhs = lhs_rv.vb;
     auto& rhs = rhs_rv.vb;
+    if (BinaryOperatorKernel::apply(op, lhs, rhs)) [[likely]] {
+        am.operand_stack.push(std::move(lhs));
+        return;
+    }
     switch (op) {
     case Opcode::add:
         if (lhs->getType().kind() == Kind::pointer) {
             COMPILER_GUARANTEE(isInteger(rhs->getType().kind()), lib::format(
                     "invalid type combination `${}` `${}` of operands of binary +", lhs->getType(), rhs->getType()));
-            pointerAdd(lhs.get<PointerValue>(), rhs.get<IntegerValue>().uint64());
+            pointerAdd(am.pointer_arithmetic_cache, lhs.get<PointerValue>(), rhs.get<IntegerValue>().uint64());
         } else if (rhs->getType().kind() == Kind::pointer) {
             COMPILER_GUARANTEE(isInteger(lhs->getType().kind()), lib::format(
                     "invalid type combination `${}` `${}` of operands of binary +", lhs->getType(), rhs->getType()));
-            pointerAdd(rhs.get<PointerValue>(), lhs.get<IntegerValue>().uint64());
+            pointerAdd(am.pointer_arithmetic_cache, rhs.get<PointerValue>(), lhs.get<IntegerValue>().uint64());
             lhs = std::move(rhs);
         } else {
             if (lhs->getType().kind() == Kind::dissociative_pointer || rhs->getType().kind() == Kind::dissociative_pointer) {
@@ -262,7 +288,7 @@ void Execute::binaryOperator(AbstractMachine& am, Opcode op)
             } else {
                 COMPILER_GUARANTEE(isInteger(rhs->getType().kind()), lib::format(
                         "invalid type combination `${}` `${}` of operands of binary -", lhs->getType(), rhs->getType()));
-                pointerAdd(lhs.get<PointerValue>(), -rhs.get<IntegerValue>().uint64());
+                pointerAdd(am.pointer_arithmetic_cache, lhs.get<PointerValue>(), -rhs.get<IntegerValue>().uint64());
             }
         } else {
             if (lhs->getType().kind() == Kind::dissociative_pointer || rhs->getType().kind() == Kind::dissociative_pointer) {
@@ -308,7 +334,7 @@ void Execute::binaryOperator(AbstractMachine& am, Opcode op)
                 throw UBException{{UB::eva_ivd_lvalue, UB::ivd_ptr_compare}, "dissociative pointer compare\n"};
             }
             POINTER_CMP_COMPILER_GUARANTEE("<");
-            lhs = ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i32),
+            lhs = ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i32),
                                             pointerCmp(lhs.get<PointerValue>(), rhs.get<PointerValue>()) < 0}};
         }
         break;
@@ -322,7 +348,7 @@ void Execute::binaryOperator(AbstractMachine& am, Opcode op)
                 throw UBException{{UB::eva_ivd_lvalue, UB::ivd_ptr_compare}, "dissociative pointer compare\n"};
             }
             POINTER_CMP_COMPILER_GUARANTEE("<=");
-            lhs = ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i32),
+            lhs = ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i32),
                                             pointerCmp(lhs.get<PointerValue>(), rhs.get<PointerValue>()) <= 0}};
         }
         break;
@@ -336,7 +362,7 @@ void Execute::binaryOperator(AbstractMachine& am, Opcode op)
                 throw UBException{{UB::eva_ivd_lvalue, UB::ivd_ptr_compare}, "dissociative pointer compare\n"};
             }
             POINTER_CMP_COMPILER_GUARANTEE(">");
-            lhs = ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i32),
+            lhs = ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i32),
                                             pointerCmp(lhs.get<PointerValue>(), rhs.get<PointerValue>()) > 0}};
         }
         break;
@@ -350,7 +376,7 @@ void Execute::binaryOperator(AbstractMachine& am, Opcode op)
                 throw UBException{{UB::eva_ivd_lvalue, UB::ivd_ptr_compare}, "dissociative pointer compare\n"};
             }
             POINTER_CMP_COMPILER_GUARANTEE(">=");
-            lhs = ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i32),
+            lhs = ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i32),
                                             pointerCmp(lhs.get<PointerValue>(), rhs.get<PointerValue>()) >= 0}};
         }
         break;
@@ -15,6 +15,7 @@
  ******************************************************************************/
 
 #include <cfloat>
+#include <utility>
 #include <execute.h>
 #include <exception.h>
 #include <foundation/type/helper.h>
@@ -30,7 +31,7 @@ using am::UB;
 
 void ValueBox::castTo(const Type& type)
 {
-    ASSERT(isArithmetic(this->value->type->kind()) && isArithmetic(type.kind()), "invalid cast");
+    ASSERT(isArithmetic(this->value()->type->kind()) && isArithmetic(type.kind()), "invalid cast");
 #ifdef __GNUC__
     static const void* const table[16][16] = {
             // bool
@@ -86,15 +87,15 @@ void ValueBox::castTo(const Type& type)
             nullptr, nullptr, nullptr, nullptr, &&f32_to_int, &&f32_to_int, &&f32_to_int, &&f32_to_int,
             &&no_cast, &&f32_to_f64},
             // f64
-            {&&f64_to_bool, &&f32_to_int, &&f64_to_int, &&f64_to_int, &&f64_to_int, &&f64_to_int,
+            {&&f64_to_bool, &&f64_to_int, &&f64_to_int, &&f64_to_int, &&f64_to_int, &&f64_to_int,
             nullptr, nullptr, nullptr, nullptr, &&f64_to_int, &&f64_to_int, &&f64_to_int, &&f64_to_int,
             &&f64_to_f32, &&no_cast},
     };
-    const void* target = table[static_cast<kind_t>(this->value->type->kind())][static_cast<kind_t>(type.kind())];
+    const void* target = table[static_cast<kind_t>(this->value()->type->kind())][static_cast<kind_t>(type.kind())];
     ASSERT(target != nullptr, "invalid type kind value");
     goto *target;
 #else
-    switch (this->value->type->kind()) {
+    switch (this->value()->type->kind()) {
     case Kind::bool_:
         switch (type.kind()) {
         case Kind::bool_:
@@ -349,7 +350,7 @@ cast_and_extend:
     }
     return;
 cast_type_only:
-    this->value->type = &type;
+    this->value()->type = &type;
     return;
 int_to_bool:
     {
@@ -361,45 +362,39 @@ int_to_bool:
 f32_to_bool:
     {
         auto& v = this->get<F32Value>();
-        this->value = new IntegerValue{&type_manager.getBasicType(Kind::bool_), v.val != 0};
-        ValueBox::delete_(&v);
+        this->emplace<IntegerValue>(&type_manager.getBasicType(Kind::bool_), v.val != 0);
     }
     return;
 f64_to_bool:
     {
         auto& v = this->get<F64Value>();
-        this->value = new IntegerValue{&type_manager.getBasicType(Kind::bool_), v.val != 0};
-        ValueBox::delete_(&v);
+        this->emplace<IntegerValue>(&type_manager.getBasicType(Kind::bool_), v.val != 0);
     }
     return;
 signed_int_to_f32:
     {
         auto& v = this->get<IntegerValue>();
         int64_t val = *reinterpret_cast<int64_t*>(&v.val);
-        this->value = new F32Value{static_cast<float>(val)};
-        ValueBox::delete_(&v);
+        this->emplace<F32Value>(static_cast<float>(val));
     }
     return;
 unsigned_int_to_f32:
     {
         auto& v = this->get<IntegerValue>();
-        this->value = new F32Value{static_cast<float>(v.val)};
-        ValueBox::delete_(&v);
+        this->emplace<F32Value>(static_cast<float>(v.val));
     }
     return;
 signed_int_to_f64:
     {
         auto& v = this->get<IntegerValue>();
         int64_t val = *reinterpret_cast<int64_t*>(&v.val);
-        this->value = new F64Value{static_cast<double>(val)};
-        ValueBox::delete_(&v);
+        this->emplace<F64Value>(static_cast<double>(val));
     }
     return;
 unsigned_int_to_f64:
     {
         auto& v = this->get<IntegerValue>();
-        this->value = new F64Value{static_cast<double>(v.val)};
-        ValueBox::delete_(&v);
+        this->emplace<F64Value>(static_cast<double>(v.val));
     }
     return;
 f32_to_int:
@@ -414,8 +409,7 @@ f32_to_int:
                     "result(${}) of float type cannot cast to integer type `${}`", v.val, type)};
         }
         uint64_t val = isUnsigned(type.kind()) ? static_cast<uint64_t>(v.val) : static_cast<int64_t>(v.val);
-        this->value = new IntegerValue{&type, val};
-        ValueBox::delete_(&v);
+        this->emplace<IntegerValue>(&type, val);
     }
     return;
 f64_to_int:
@@ -430,15 +424,13 @@ f64_to_int:
                     "result(${}) of double type cannot cast to integer type `${}`", v.val, type)};
         }
         uint64_t val = isUnsigned(type.kind()) ? static_cast<uint64_t>(v.val) : static_cast<int64_t>(v.val);
-        this->value = new IntegerValue{&type, val};
-        ValueBox::delete_(&v);
+        this->emplace<IntegerValue>(&type, val);
     }
     return;
 f32_to_f64:
     {
         auto& v = this->get<F32Value>();
-        this->value = new F64Value{v.val};
-        ValueBox::delete_(&v);
+        this->emplace<F64Value>(v.val);
     }
     return;
 f64_to_f32:
@@ -448,14 +440,101 @@ f64_to_f32:
             throw UBException{{UB::real_float_demotion}, lib::format(
                     "result(${}) of double type cannot cast to float", v.val)};
         }
-        this->value = new F32Value{static_cast<float>(v.val)};
-        ValueBox::delete_(&v);
+        this->emplace<F32Value>(static_cast<float>(v.val));
     }
     return;
 no_cast:
     return;
 }
 
+namespace {
+// whether value of integer kind `from` keeps its representation as a value of integer kind `to`,
+//   i.e. only type of the value needs to be changed, see `table` of `ValueBox::castTo`
+constexpr bool isRepresentationKept(Kind from, Kind to)
+{
+    if (from == Kind::bool_) {
+        return true;
+    }
+    auto from_rank = integerTypeRank(from == Kind::char_ ? Kind::i8 : from);
+    auto to_rank = integerTypeRank(to == Kind::char_ ? Kind::i8 : to);
+    if (isUnsigned(to)) {
+        return isUnsigned(from) && to_rank >= from_rank;
+    }
+    return isUnsigned(from) ? to_rank > from_rank : to_rank >= from_rank;
+}
+
+// same as `IntegerValue::extend` of type of kind `kind`
+template<Kind kind>
+uint64_t extendTo(uint64_t value) noexcept
+{
+    constexpr Kind k = kind == Kind::char_ ? Kind::i8 : kind;
+    constexpr int width = 8 << (integerTypeRank(k) - 2);
+    if constexpr (width == 64) {
+        return value;
+    } else if constexpr (isUnsigned(k)) {
+        return value & ((1ULL << width) - 1);
+    } else {
+        uint64_t tmp = value << (64 - width);
+        return *reinterpret_cast<const int64_t*>(&tmp) >> (64 - width);
+    }
+}
+} // anonymous namespace
+
+template<Kind from, Kind to>
+void ValueBox::castTo(const Type& type)
+{
+    static_assert(isArithmetic(from) && isArithmetic(to));
+    ASSERT(this->value()->type->kind() == from && type.kind() == to, "kind mismatch");
+    if constexpr (from == to) {
+        return;
+    } else if constexpr (isInteger(from) && to == Kind::bool_) {
+        auto& v = this->get<IntegerValue>();
+        v.type = &type;
+        v.val = v.val != 0;
+    } else if constexpr (isInteger(from) && isInteger(to)) {
+        auto& v = this->get<IntegerValue>();
+        v.type = &type;
+        if constexpr (!isRepresentationKept(from, to)) {
+            v.val = extendTo<to>(v.val);
+        }
+    } else if constexpr (isInteger(from)) {
+        using F = std::conditional_t<to == Kind::f32, float, double>;
+        using V = std::conditional_t<to == Kind::f32, F32Value, F64Value>;
+        auto& v = this->get<IntegerValue>();
+        if constexpr (from != Kind::bool_ && isSigned(from)) {
+            int64_t val = *reinterpret_cast<int64_t*>(&v.val);
+            this->emplace<V>(static_cast<F>(val));
+        } else {
+            this->emplace<V>(static_cast<F>(v.val));
+        }
+    } else {
+        using F = std::conditional_t<from == Kind::f32, float, double>;
+        auto& v = this->get<std::conditional_t<from == Kind::f32, F32Value, F64Value>>();
+        if constexpr (to == Kind::bool_) {
+            this->emplace<IntegerValue>(&type, v.val != 0);
+        } else if constexpr (isInteger(to)) {
+            constexpr Kind kind = to == Kind::char_ ? Kind::i8 : to;
+            auto min = static_cast<F>(getMinValue(kind));
+            auto max = static_cast<F>(getMaxValue(kind));
+            if (v.val < min || v.val > max) {
+                throw UBException{{UB::cast_to_or_from_integer}, lib::format(
+                        "result(${}) of ${} type cannot cast to integer type `${}`", v.val,
+                        from == Kind::f32 ? "float" : "double", type)};
+            }
+            uint64_t val = isUnsigned(to) ? static_cast<uint64_t>(v.val) : static_cast<int64_t>(v.val);
+            this->emplace<IntegerValue>(&type, val);
+        } else if constexpr (to == Kind::f64) {
+            this->emplace<F64Value>(v.val);
+        } else {
+            if (v.val < FLT_MIN || v.val > FLT_MAX) {
+                throw UBException{{UB::real_float_demotion}, lib::format(
+                        "result(${}) of double type cannot cast to float", v.val)};
+            }
+            this->emplace<F32Value>(static_cast<float>(v.val));
+        }
+    }
+}
+
 namespace {
 // determine whether `object` or its subobject or subsubobject ...(all with the same address) is designated
 lib::Optional<Object*> resolveObjectDesignation(Object* object, const Type& type) // NOLINT
@@ -501,15 +580,12 @@ lib::Optional<Object*> designateObject(Object* object, uint64_t offset, const Ty
         return designateObject(object->sub_objects[offset / sub_obj_size], offset % sub_obj_size, type);
     } else if (obj_type.kind() == Kind::struct_) {
         auto& t = down_cast<const Struct&>(obj_type);
-        uint64_t off = 0;
-        for (size_t i = 0; i < t.members.length(); ++i) {
-            off = lib::roundUp(off, t.members[i]->align()) + t.members[i]->size();
-            if (off > offset) {
-                ASSERT(i < object->sub_objects.length(), "invalid offset or sub_object size miss matches the type size");
-                return designateObject(object->sub_objects[i], offset - (off - t.members[i]->size()), type);
-            }
+        auto i = t.memberIndexAt(offset);
+        if (i == t.members.length()) {
+            return nullptr;
         }
-        return nullptr;
+        ASSERT(i < object->sub_objects.length(), "invalid offset or sub_object size miss matches the type size");
+        return designateObject(object->sub_objects[i], offset - t.offsets()[i], type);
     } else if (obj_type.kind() == Kind::union_) {
         for (auto item: object->sub_objects) {
             if (auto o = designateObject(item, offset, type); o) {
@@ -539,36 +615,31 @@ void Execute::castIntegerToPointer(AbstractMachine& am, ValueBox& operand, const
 {
     ASSERT(type.kind() == Kind::pointer, "precondition violation");
     auto int_val = operand.get<IntegerValue>().uint64();
-    auto itr = am.state.entities.upper_bound(int_val);
-    if (itr == am.state.entities.begin()) {
-        operand = ValueBox{new DissociativePointerValue{&type, int_val}};
+    auto top_obj = am.object_manager.findTopObject(int_val);
+    if (!top_obj) {
+        operand = ValueBox{DissociativePointerValue{&type, int_val}};
         return;
     }
-    --itr;
-    auto entity = itr->second;
+    auto* obj = *top_obj;
     auto& ref_type = removeQualify(down_cast<const Pointer&>(type).referenced);
-    if (entity->effective_type.kind() == Kind::function || ref_type.kind() == Kind::function) {
-        if (int_val != itr->first) {
-            operand = ValueBox{new DissociativePointerValue{&type, int_val}};
+    if (ref_type.kind() == Kind::function) {
+        if (int_val != obj->address) {
+            operand = ValueBox{DissociativePointerValue{&type, int_val}};
         } else {
-            operand = ValueBox{new PointerValue{&type, entity, 0}};
+            operand = ValueBox{PointerValue{&type, obj, 0}};
         }
         return;
     }
-    auto* obj = down_cast<Object*>(entity);
-    if (int_val - itr->first >= obj->effective_type.size()) {
-        operand = ValueBox{new DissociativePointerValue{&type, int_val}};
-        return;
-    }
-    if (auto ref_obj = designateObject(obj, int_val - itr->first, ref_type);ref_obj) {
-        operand = ValueBox{new PointerValue{&type, *ref_obj, int_val - (*ref_obj)->address}};
+    if (auto ref_obj = designateObject(obj, int_val - obj->address, ref_type);ref_obj) {
+        operand = ValueBox{PointerValue{&type, *ref_obj, int_val - (*ref_obj)->address}};
         return;
     }
-    operand = ValueBox{new DissociativePointerValue{&type, int_val}};
+    operand = ValueBox{DissociativePointerValue{&type, int_val}};
 }
 
-void Execute::castPointerToPointer(ValueBox& operand, const ts::Type& type)
+void Execute::castPointerToPointer(AbstractMachine&, ValueBox& operand, const CastPlan& plan)
 {
+    auto& type = *plan.type;
     ASSERT(type.kind() == Kind::pointer, "precondition violation");
     auto& ptr = operand.get<PointerValue>();
     auto& ptr_ref_type = down_cast<const Pointer&>(ptr.getType()).referenced;
@@ -586,12 +657,10 @@ void Execute::castPointerToPointer(ValueBox& operand, const ts::Type& type)
         return;
     }
     // equivalent to `ptr.getAddress() % type.align()`
-    if (cast_type_ref_type.kind() != Kind::void_ && ptr.getAddress() & (cast_type_ref_type.align() - 1)) {
+    if (ptr.getAddress() & plan.align_mask) {
         throw UBException{{UB::unaligned_ptr_cast}, lib::format(
                 "pointer cast from `${}` to an unaligned type `${}`", ptr.getType(), type)};
     }
-    ASSERT(cast_type_ref_type.kind() == Kind::void_ || ((cast_type_ref_type.align() - 1) & cast_type_ref_type.align()) == 0,
-           "align must be the power of 2");
     // cast may cause change of referenced object
     //  e.g. `int (*) [2]` cast to `int*`, referenced object changes from array to int
     if (auto obj = ptr.getReferenced(); obj) {
@@ -609,62 +678,58 @@ void Execute::castPointerToPointer(ValueBox& operand, const ts::Type& type)
     }
 }
 
-void Execute::cast(AbstractMachine& am, InstrInfo info)
+void Execute::castDissociativePointerToPointer(AbstractMachine&, ValueBox& operand, const CastPlan& plan)
 {
-    // evaluation of cast expression will discard qualifier of the type of the result
-    //  so type to which cast has no meaning to be qualified
-    COMPILER_GUARANTEE(info.getTypeID() < am.static_info.types.length(),
-                       lib::format("Value(${}) of type id out of boundary(${})", info.getTypeID(), am.static_info.types.length()));
-    auto& type = removeQualify(*am.static_info.types[info.getTypeID()]);
-    auto& rich_value = am.operand_stack.top();
-    if (rich_value.attr.indeterminate) {
-        return;
+    auto& type = *plan.type;
+    ASSERT(type.kind() == Kind::pointer, "precondition violation");
+    auto& op_type = operand.get<DissociativePointerValue>().pointer_type;
+    auto& op_ref_type = down_cast<const Pointer&>(*op_type).referenced;
+    // equivalent to `address % align != 0`, `align_mask` is zero if referenced type of `type` is function
+    if (op_ref_type.kind() != Kind::function && (operand.get<DissociativePointerValue>().address & plan.align_mask)) {
+        throw UBException{{UB::unaligned_ptr_cast}, lib::format(
+                "pointer cast from `${}` to an unaligned type `${}`", *op_type, type)};
     }
-    auto& operand = rich_value.vb;
+    op_type = &type;
+}
+
+void Execute::castGenerically(AbstractMachine& am, ValueBox& operand, const CastPlan& plan)
+{
+    auto& type = *plan.type;
     COMPILER_GUARANTEE(isScalar(type.kind()) &&
                        (isScalar(operand->getType().kind()) || operand->getType().kind() == Kind::dissociative_pointer),
                        lib::format("invalid type in cast operator. cast from `${}` to `${}`", operand->getType(), type));
     if (operand->getType().kind() == Kind::null) {
         if (type.kind() == Kind::pointer) {
-            operand = ValueBox{new PointerValue{&type, nullptr, 0}};
+            operand = ValueBox{PointerValue{&type, nullptr, 0}};
         } else if (type.kind() == Kind::bool_) {
-            operand = ValueBox{new IntegerValue{false}};
+            operand = ValueBox{IntegerValue{false}};
         } else {
             COMPILER_GUARANTEE(type.kind() == Kind::null, lib::format("cast nullptr to a non-nullptr_t type `${}`", type));
         }
     } else if (operand->getType().kind() == Kind::pointer) {
         if (type.kind() == Kind::pointer) {
-            Execute::castPointerToPointer(operand, type);
+            Execute::castPointerToPointer(am, operand, plan);
         } else {
             COMPILER_GUARANTEE(isInteger(type.kind()), lib::format("cast pointer to a non-pointer non-integer type `${}`", type));
             if (type.kind() == Kind::bool_) {
-                operand = ValueBox{new IntegerValue{!operand.get<PointerValue>().isZero()}};
+                operand = ValueBox{IntegerValue{!operand.get<PointerValue>().isZero()}};
             } else {
                 auto addr = operand.get<PointerValue>().getAddress();
                 checkPointerToInteger(addr, type);
-                operand = ValueBox{new IntegerValue{&type, addr}};
+                operand = ValueBox{IntegerValue{&type, addr}};
             }
         }
     } else if (operand->getType().kind() == Kind::dissociative_pointer) {
         if (type.kind() == Kind::pointer) {
-            auto& op_type = operand.get<DissociativePointerValue>().pointer_type;
-            auto& op_ref_type = down_cast<const Pointer&>(*op_type).referenced;
-            auto& cast_ref_type = down_cast<const Pointer&>(type).referenced;
-            if (op_ref_type.kind() != Kind::function && cast_ref_type.kind() != Kind::function && cast_ref_type.kind() != Kind::void_ &&
-                // equivalent to `address % align != 0`
-                (operand.get<DissociativePointerValue>().address & (cast_ref_type.align() - 1))) {
-                throw UBException{{UB::unaligned_ptr_cast}, lib::format(
-                        "pointer cast from `${}` to an unaligned type `${}`", *op_type, type)};
-            }
-            op_type = &type;
+            Execute::castDissociativePointerToPointer(am, operand, plan);
         } else {
             COMPILER_GUARANTEE(isInteger(type.kind()), lib::format("cast pointer to a non-pointer non-integer type `${}`", type));
             if (type.kind() == Kind::bool_) {
-                operand = ValueBox{new IntegerValue{operand.get<DissociativePointerValue>().address != 0}};
+                operand = ValueBox{IntegerValue{operand.get<DissociativePointerValue>().address != 0}};
             } else {
                 auto addr = operand.get<DissociativePointerValue>().address;
                 checkPointerToInteger(addr, type);
-                operand = ValueBox{new IntegerValue{&type, addr}};
+                operand = ValueBox{IntegerValue{&type, addr}};
             }
         }
     } else {
@@ -679,3 +744,75 @@ void Execute::cast(AbstractMachine& am, InstrInfo info)
         }
     }
 }
+
+namespace {
+using ArithmeticKinds = std::integer_sequence<ts::kind_t,
+        static_cast<ts::kind_t>(Kind::bool_), static_cast<ts::kind_t>(Kind::char_),
+        static_cast<ts::kind_t>(Kind::i8), static_cast<ts::kind_t>(Kind::i16),
+        static_cast<ts::kind_t>(Kind::i32), static_cast<ts::kind_t>(Kind::i64),
+        static_cast<ts::kind_t>(Kind::u8), static_cast<ts::kind_t>(Kind::u16),
+        static_cast<ts::kind_t>(Kind::u32), static_cast<ts::kind_t>(Kind::u64),
+        static_cast<ts::kind_t>(Kind::f32), static_cast<ts::kind_t>(Kind::f64)>;
+
+template<Kind from, Kind to>
+void castArithmetic(am::AbstractMachine&, ValueBox& operand, const am::CastPlan& plan)
+{
+    operand.castTo<from, to>(*plan.type);
+}
+
+template<Kind to, ts::kind_t... from>
+void setArithmeticRoutines(am::CastPlan& plan, std::integer_sequence<ts::kind_t, from...>)
+{
+    ((plan.routines[from] = &castArithmetic<static_cast<Kind>(from), to>), ...);
+}
+
+template<ts::kind_t... to>
+void setArithmeticRoutines(am::CastPlan& plan, Kind kind, std::integer_sequence<ts::kind_t, to...>)
+{
+    ((kind == static_cast<Kind>(to) ? setArithmeticRoutines<static_cast<Kind>(to)>(plan, ArithmeticKinds{}) : void()), ...);
+}
+} // anonymous namespace
+
+am::CastPlan Execute::createCastPlan(const ts::Type& type)
+{
+    // evaluation of cast expression will discard qualifier of the type of the result
+    //  so type to which cast has no meaning to be qualified
+    CastPlan plan{};
+    plan.type = &removeQualify(type);
+    for (auto& item: plan.routines) {
+        item = &Execute::castGenerically;
+    }
+    // casts between pointer and integer, from nullptr and invalid casts are left to `castGenerically`
+    if (isArithmetic(plan.type->kind())) {
+        setArithmeticRoutines(plan, plan.type->kind(), ArithmeticKinds{});
+    } else if (plan.type->kind() == Kind::pointer) {
+        auto& ref_type = removeQualify(down_cast<const Pointer*>(plan.type)->referenced);
+        if (ref_type.kind() != Kind::function && ref_type.kind() != Kind::void_) {
+            ASSERT(((ref_type.align() - 1) & ref_type.align()) == 0, "align must be the power of 2");
+            plan.align_mask = ref_type.align() - 1;
+        }
+        plan.routines[static_cast<ts::kind_t>(Kind::pointer)] = &Execute::castPointerToPointer;
+        plan.routines[static_cast<ts::kind_t>(Kind::dissociative_pointer)] = &Execute::castDissociativePointerToPointer;
+    }
+    return plan;
+}
+
+template<bool verified>
+void Execute::cast(AbstractMachine& am, InstrInfo info)
+{
+    if constexpr (!verified) {
+        COMPILER_GUARANTEE(info.getTypeID() < am.cast_plans.length(),
+                           lib::format("Value(${}) of type id out of boundary(${})", info.getTypeID(), am.cast_plans.length()));
+    }
+    auto& plan = am.cast_plans[info.getTypeID()];
+    auto& rich_value = am.operand_stack.top();
+    if (rich_value.attr.indeterminate) {
+        return;
+    }
+    auto& operand = rich_value.vb;
+    plan.routines[static_cast<ts::kind_t>(operand->getType().kind())](am, operand, plan);
+}
+
+template void Execute::cast<false>(AbstractMachine& am, InstrInfo info);
+
+template void Execute::cast<true>(AbstractMachine& am, InstrInfo info);
@@ -15,6 +15,7 @@
  ******************************************************************************/
 
 #include <foundation/value.h>
+#include <lib/overflow.h>
 #include <foundation/type/helper.h>
 #include <exception.h>
 #include <ub.h>
@@ -50,24 +51,61 @@ uint64_t IntegerValue::negation() const
     return -this->val;
 }
 
+namespace {
+template<typename T>
+struct CheckedAdd
+{
+    static bool call(T a, T b, T* res) noexcept
+    {
+        return lib::addOverflow(a, b, res);
+    }
+};
+
+template<typename T>
+struct CheckedMul
+{
+    static bool call(T a, T b, T* res) noexcept
+    {
+        return lib::mulOverflow(a, b, res);
+    }
+};
+
+// performs the checked operation in the width of `T` and sign-extends the (possibly wrapped) result
+template<typename T, template<typename> typename Checked>
+inline bool overflowIn(uint64_t lhs, uint64_t rhs, uint64_t& res) noexcept
+{
+    T tmp;
+    auto overflow = Checked<T>::call(static_cast<T>(lhs), static_cast<T>(rhs), &tmp);
+    res = static_cast<uint64_t>(static_cast<int64_t>(tmp));
+    return overflow;
+}
+
+template<template<typename> typename Checked>
+bool signedOverflow(Kind kind, uint64_t lhs, uint64_t rhs, uint64_t& res) noexcept
+{
+    switch (kind) {
+    case Kind::i8:
+        return overflowIn<int8_t, Checked>(lhs, rhs, res);
+    case Kind::i16:
+        return overflowIn<int16_t, Checked>(lhs, rhs, res);
+    case Kind::i32:
+        return overflowIn<int32_t, Checked>(lhs, rhs, res);
+    default:
+        ASSERT(kind == Kind::i64, "signed integer kind expected");
+        return overflowIn<int64_t, Checked>(lhs, rhs, res);
+    }
+}
+} // anonymous namespace
+
 uint64_t IntegerValue::add(IntegerValue* rhs) const
 {
     ASSERT(this->type->kind() == rhs->type->kind() && integerTypeRank(this->type->kind()) >= integerTypeRank(Kind::i32),
            "integer promotion or usual arithmetic conversion is not correctly performed");
-    auto res = this->val + rhs->val;
-    auto overflow = [&]() -> bool {
-        if (isUnsigned(this->type->kind())) {
-            return false;
-        }
-        if (this->type->kind() == Kind::i32) {
-            return ((res >> 1) ^ res) & 0x8000'0000;
-        }
-        constexpr uint64_t MASK = ~(1ULL << 63);
-        auto msb_carry = ((this->val & MASK) + (rhs->val & MASK)) >> 63;
-        auto sb_carry = ((this->val >> 63) + (rhs->val >> 63) + msb_carry) >> 1;
-        return msb_carry ^ sb_carry;
-    }();
-    if (overflow) {
+    if (isUnsigned(this->type->kind())) {
+        return this->val + rhs->val;
+    }
+    uint64_t res;
+    if (signedOverflow<CheckedAdd>(this->type->kind(), this->val, rhs->val, res)) {
         throw UBException{{UB::exceptional_condition}, lib::format(
                 "Integer addition overflow. lhs = `${}`, rhs = `${}`", *this, *rhs)};
     }
@@ -81,44 +119,12 @@ uint64_t IntegerValue::mul(IntegerValue* rhs) const
     if (isUnsigned(this->type->kind())) {
         return this->val * rhs->val;
     }
-    const int64_t lhs_val = *reinterpret_cast<const int64_t*>(&this->val);
-    const int64_t rhs_val = *reinterpret_cast<const int64_t*>(&rhs->val);
-    const auto abs = [](int64_t v) -> uint64_t {
-        return v > 0 ? v : -static_cast<uint64_t>(v);
-    };
-    auto [overflow, result] = [&]() -> std::pair<bool, uint64_t> {
-        if (this->type->kind() == Kind::i32) {
-            auto res = lhs_val * rhs_val;
-            auto signed_res = *reinterpret_cast<int64_t*>(&res);
-            return {signed_res > INT32_MAX || signed_res < INT32_MIN, res};
-        }
-        // treat `a * b` as `(a1 + a0 * 2**32) * (b1 + b0 * 2**32)`
-        const uint64_t lhs_hi = abs(lhs_val) >> 32;
-        const uint64_t lhs_lo = abs(lhs_val) & 0xffff'ffff;
-        const uint64_t rhs_hi = abs(rhs_val) >> 32;
-        const uint64_t rhs_lo = abs(rhs_val) & 0xffff'ffff;
-        const bool positive = (lhs_val > 0) == (rhs_val > 0);
-        if (lhs_hi != 0 && rhs_hi != 0) { // quadratic factor should be zero
-            return {true, 0}; // value of `result` doesn't matter if overflow
-        }
-        const auto constant_factor = lhs_lo * rhs_lo;
-        const auto linear_factor = lhs_lo * rhs_hi + lhs_hi * rhs_lo;
-        if (linear_factor >> 32 != 0 || linear_factor + (constant_factor >> 32) > UINT32_MAX) {
-            return {true, 0};
-        }
-        auto res_abs = (linear_factor << 32) + constant_factor;
-        if (positive) {
-            return {res_abs > INT64_MAX, res_abs};
-        }
-        // clangd says that the below expression is always `false`, it should be false alarm
-        //   e.g. a1 = b1 = 0xcfff'ffff, a0 = b0 = 0
-        return {res_abs > static_cast<uint64_t>(INT64_MIN), -res_abs};
-    }();
-    if (overflow) {
+    uint64_t res;
+    if (signedOverflow<CheckedMul>(this->type->kind(), this->val, rhs->val, res)) {
         throw UBException{{UB::exceptional_condition}, lib::format(
                 "Integer multiply overflow. lhs = `${}`, rhs = `${}`", *this, *rhs)};
     }
-    return result;
+    return res;
 }
 
 uint64_t IntegerValue::div(IntegerValue* rhs) const
@@ -260,74 +266,74 @@ bool IntegerValue::isZero() const noexcept
     return this->val == 0;
 }
 
-IntegerValue* IntegerValue::operator~() const
+IntegerValue IntegerValue::operator~() const
 {
-    return new IntegerValue{this->type, this->complement()};
+    return IntegerValue{this->type, this->complement()};
 }
 
-IntegerValue* IntegerValue::operator-() const
+IntegerValue IntegerValue::operator-() const
 {
-    return new IntegerValue{this->type, this->negation()};
+    return IntegerValue{this->type, this->negation()};
 }
 
-IntegerValue* IntegerValue::operator+(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator+(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->add(rhs)};
+    return IntegerValue{this->type, this->add(rhs)};
 }
 
-IntegerValue* IntegerValue::operator*(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator*(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->mul(rhs)};
+    return IntegerValue{this->type, this->mul(rhs)};
 }
 
-IntegerValue* IntegerValue::operator/(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator/(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->div(rhs)};
+    return IntegerValue{this->type, this->div(rhs)};
 }
 
-IntegerValue* IntegerValue::operator%(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator%(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->mod(rhs)};
+    return IntegerValue{this->type, this->mod(rhs)};
 }
 
-IntegerValue* IntegerValue::operator<(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator<(IntegerValue* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->less(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->less(rhs)};
 }
 
-IntegerValue* IntegerValue::operator<=(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator<=(IntegerValue* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->lessEqual(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->lessEqual(rhs)};
 }
 
-IntegerValue* IntegerValue::operator==(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator==(IntegerValue* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->equal(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->equal(rhs)};
 }
 
-IntegerValue* IntegerValue::operator&(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator&(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->bitwiseAnd(rhs)};
+    return IntegerValue{this->type, this->bitwiseAnd(rhs)};
 }
 
-IntegerValue* IntegerValue::operator|(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator|(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->bitwiseOr(rhs)};
+    return IntegerValue{this->type, this->bitwiseOr(rhs)};
 }
 
-IntegerValue* IntegerValue::operator^(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator^(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->bitwiseXor(rhs)};
+    return IntegerValue{this->type, this->bitwiseXor(rhs)};
 }
 
-IntegerValue* IntegerValue::operator<<(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator<<(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->leftShift(rhs)};
+    return IntegerValue{this->type, this->leftShift(rhs)};
 }
 
-IntegerValue* IntegerValue::operator>>(IntegerValue* rhs) const
+IntegerValue IntegerValue::operator>>(IntegerValue* rhs) const
 {
-    return new IntegerValue{this->type, this->rightShift(rhs)};
+    return IntegerValue{this->type, this->rightShift(rhs)};
 }
 
 IntegerValue* IntegerValue::inplaceComplement()
@@ -430,39 +436,39 @@ bool F32Value::isZero() const noexcept
     return this->val == 0;
 }
 
-F32Value* F32Value::operator-() const
+F32Value F32Value::operator-() const
 {
-    return new F32Value{this->negation()};
+    return F32Value{this->negation()};
 }
 
-F32Value* F32Value::operator+(F32Value* rhs) const
+F32Value F32Value::operator+(F32Value* rhs) const
 {
-    return new F32Value{this->add(rhs)};
+    return F32Value{this->add(rhs)};
 }
 
-F32Value* F32Value::operator*(F32Value* rhs) const
+F32Value F32Value::operator*(F32Value* rhs) const
 {
-    return new F32Value{this->mul(rhs)};
+    return F32Value{this->mul(rhs)};
 }
 
-F32Value* F32Value::operator/(F32Value* rhs) const
+F32Value F32Value::operator/(F32Value* rhs) const
 {
-    return new F32Value{this->div(rhs)};
+    return F32Value{this->div(rhs)};
 }
 
-IntegerValue* F32Value::operator<(F32Value* rhs) const
+IntegerValue F32Value::operator<(F32Value* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->less(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->less(rhs)};
 }
 
-IntegerValue* F32Value::operator<=(F32Value* rhs) const
+IntegerValue F32Value::operator<=(F32Value* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->lessEqual(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->lessEqual(rhs)};
 }
 
-IntegerValue* F32Value::operator==(F32Value* rhs) const
+IntegerValue F32Value::operator==(F32Value* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->equal(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->equal(rhs)};
 }
 
 F32Value* F32Value::inplaceNegation()
@@ -529,39 +535,39 @@ bool F64Value::isZero() const noexcept
     return this->val == 0;
 }
 
-F64Value* F64Value::operator-() const
+F64Value F64Value::operator-() const
 {
-    return new F64Value{this->negation()};
+    return F64Value{this->negation()};
 }
 
-F64Value* F64Value::operator+(F64Value* rhs) const
+F64Value F64Value::operator+(F64Value* rhs) const
 {
-    return new F64Value{this->add(rhs)};
+    return F64Value{this->add(rhs)};
 }
 
-F64Value* F64Value::operator*(F64Value* rhs) const
+F64Value F64Value::operator*(F64Value* rhs) const
 {
-    return new F64Value{this->mul(rhs)};
+    return F64Value{this->mul(rhs)};
 }
 
-F64Value* F64Value::operator/(F64Value* rhs) const
+F64Value F64Value::operator/(F64Value* rhs) const
 {
-    return new F64Value{this->div(rhs)};
+    return F64Value{this->div(rhs)};
 }
 
-IntegerValue* F64Value::operator<(F64Value* rhs) const
+IntegerValue F64Value::operator<(F64Value* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->less(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->less(rhs)};
 }
 
-IntegerValue* F64Value::operator<=(F64Value* rhs) const
+IntegerValue F64Value::operator<=(F64Value* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->lessEqual(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->lessEqual(rhs)};
 }
 
-IntegerValue* F64Value::operator==(F64Value* rhs) const
+IntegerValue F64Value::operator==(F64Value* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->equal(rhs)};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->equal(rhs)};
 }
 
 F64Value* F64Value::inplaceNegation()
@@ -617,14 +623,14 @@ bool PointerValue::checkInvariant()
 
 #endif
 
-IntegerValue* PointerValue::operator==(PointerValue* rhs) const
+IntegerValue PointerValue::operator==(PointerValue* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->getAddress() == rhs->getAddress()};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->getAddress() == rhs->getAddress()};
 }
 
-IntegerValue* PointerValue::operator==(NullValue*) const
+IntegerValue PointerValue::operator==(NullValue*) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), this->isZero()};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), this->isZero()};
 }
 
 void PointerValue::set(const Type* type)
@@ -673,12 +679,12 @@ uint64_t PointerValue::getAddress() const noexcept
     return (*this->entity)->address + this->offset;
 }
 
-IntegerValue* NullValue::operator==(PointerValue* rhs) const
+IntegerValue NullValue::operator==(PointerValue* rhs) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), rhs->isZero()};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), rhs->isZero()};
 }
 
-IntegerValue* NullValue::operator==(NullValue*) const
+IntegerValue NullValue::operator==(NullValue*) const
 {
-    return new IntegerValue{&type_manager.getBasicType(Kind::i32), true};
+    return IntegerValue{&type_manager.getBasicType(Kind::i32), true};
 }
@@ -119,13 +119,15 @@ ValueBox am::operator==(ValueBox lhs, ValueBox rhs) // NOLINT
 {
     ASSERT((isPointerLike(lhs->type->kind()) && isPointerLike(rhs->type->kind())) ||
            (isArithmetic(lhs->type->kind()) || isArithmetic(rhs->type->kind())), "invalid type");
+    // convert before dispatching, since kind of lhs may be changed(e.g. `i32 == f32`, `f32 == f64`)
+    if (isArithmetic(lhs->type->kind())) {
+        ValueBox::usualArithmeticConvert(lhs, rhs);
+    }
     auto res = [&]() {
         switch (lhs->type->kind()) {
         case Kind::f32:
-            ValueBox::usualArithmeticConvert(lhs, rhs);
             return *static_cast<F32Value*>(lhs) == static_cast<F32Value*>(rhs);
         case Kind::f64:
-            ValueBox::usualArithmeticConvert(lhs, rhs);
             return *static_cast<F64Value*>(lhs) == static_cast<F64Value*>(rhs);
         case Kind::pointer:
             return rhs->type->kind() == Kind::pointer ?
@@ -137,7 +139,6 @@ ValueBox am::operator==(ValueBox lhs, ValueBox rhs) // NOLINT
                    *static_cast<NullValue*>(lhs) == static_cast<NullValue*>(rhs);
         default:
             ASSERT(isInteger(lhs->type->kind()), "no other type kind allowed");
-            ValueBox::usualArithmeticConvert(lhs, rhs);
             return *static_cast<IntegerValue*>(lhs) == static_cast<IntegerValue*>(rhs);
         }
     }();
@@ -309,22 +310,22 @@ ValueBox ValueBox::operator~() const
 
 ValueBox ValueBox::operator!() const
 {
-    ASSERT(isArithmetic(this->value->type->kind()) || this->value->type->kind() == Kind::pointer, "invalid type");
-    return ValueBox{new IntegerValue{&type_manager.getBasicType(Kind::i32), this->isZero()}};
+    ASSERT(isArithmetic(this->value()->type->kind()) || this->value()->type->kind() == Kind::pointer, "invalid type");
+    return ValueBox{IntegerValue{&type_manager.getBasicType(Kind::i32), this->isZero()}};
 }
 
 void ValueBox::inplacePositive()
 {
-    ASSERT(isArithmetic(this->value->type->kind()) || this->value->type->kind() == Kind::pointer, "invalid type");
-    if (isInteger(this->value->type->kind())) {
-        integerPromote(this->value);
+    ASSERT(isArithmetic(this->value()->type->kind()) || this->value()->type->kind() == Kind::pointer, "invalid type");
+    if (isInteger(this->value()->type->kind())) {
+        integerPromote(this->value());
     }
 }
 
 void ValueBox::inplaceNegation()
 {
-    ASSERT(isArithmetic(this->value->type->kind()), "invalid type");
-    auto kind = this->value->type->kind();
+    ASSERT(isArithmetic(this->value()->type->kind()), "invalid type");
+    auto kind = this->value()->type->kind();
     if (kind == Kind::f32) {
         this->get<F32Value>().inplaceNegation();
         return;
@@ -340,8 +341,8 @@ void ValueBox::inplaceNegation()
 
 bool ValueBox::isZero() const
 {
-    ASSERT(isArithmetic(this->value->type->kind()) || this->value->type->kind() == Kind::pointer, "invalid type");
-    switch (this->value->type->kind()) {
+    ASSERT(isArithmetic(this->value()->type->kind()) || this->value()->type->kind() == Kind::pointer, "invalid type");
+    switch (this->value()->type->kind()) {
     case Kind::f32:
         return this->get<F32Value>().isZero();
     case Kind::f64:
@@ -351,14 +352,14 @@ bool ValueBox::isZero() const
     case Kind::null:
         return true;
     default:
-        ASSERT(isInteger(this->value->type->kind()), "no other type kind allowed");
+        ASSERT(isInteger(this->value()->type->kind()), "no other type kind allowed");
         return this->get<IntegerValue>().isZero();
     }
 }
 
 void ValueBox::inplaceComplement()
 {
-    ASSERT(isInteger(this->value->type->kind()), "invalid type");
+    ASSERT(isInteger(this->value()->type->kind()), "invalid type");
     auto& v = this->get<IntegerValue>();
     integerPromote(&v);
     v.inplaceComplement();
@@ -412,8 +413,8 @@ void ValueBox::usualArithmeticConvert(ValueBox& lhs, ValueBox& rhs)
     if (isFloat(lhs_kind) || isFloat(rhs_kind)) {
         return ValueBox::toFloat_uac(lhs, rhs);
     }
-    integerPromote(lhs.value);
-    integerPromote(rhs.value);
+    integerPromote(lhs.value());
+    integerPromote(rhs.value());
     if (lhs_kind == rhs_kind) {
         return;
     }
@@ -449,65 +450,3 @@ ValueBox ValueBox::cast(const ts::Type& type)
     vb.castTo(type);
     return std::move(vb);
 }
-
-void ValueBox::delete_(Value* value)
-{
-    ASSERT(value != nullptr, "Value::delete_ is not nullptr-safe");
-    switch (value->type->kind()) {
-    case Kind::f32:
-        delete down_cast<F32Value*>(value);
-        break;
-    case Kind::f64:
-        delete down_cast<F64Value*>(value);
-        break;
-    case Kind::pointer:
-        delete down_cast<PointerValue*>(value);
-        break;
-    case Kind::dissociative_pointer:
-        delete down_cast<DissociativePointerValue*>(value);
-        break;
-    case Kind::struct_:
-    case Kind::union_:
-        delete down_cast<StructOrUnionValue*>(value);
-        break;
-    case Kind::null:
-        delete down_cast<NullValue*>(value);
-        break;
-    case Kind::ivd:
-        delete down_cast<UndefinedValue*>(value);
-        break;
-    default:
-        ASSERT(isInteger(value->type->kind()), "no other type kind allowed");
-        delete down_cast<IntegerValue*>(value);
-        break;
-    }
-}
-
-Value* ValueBox::copy(Value* value)
-{
-    ASSERT(value != nullptr, "Value::copy is not nullptr-safe");
-    switch (value->type->kind()) {
-    case Kind::f32:
-        return new F32Value{down_cast<F32Value*>(value)->val};
-    case Kind::f64:
-        return new F64Value{down_cast<F64Value*>(value)->val};
-    case Kind::pointer: {
-        auto v = down_cast<PointerValue*>(value);
-        return new PointerValue{v->type, *v->entity, v->offset};
-    }
-    case Kind::dissociative_pointer: {
-        auto v = down_cast<DissociativePointerValue*>(value);
-        return new DissociativePointerValue{v->type, v->address};
-    }
-    case Kind::struct_:
-    case Kind::union_:
-        return new StructOrUnionValue{value->type, down_cast<StructOrUnionValue*>(value)->obj};
-    case Kind::null:
-        return new NullValue{};
-    case Kind::ivd:
-        return new UndefinedValue{};
-    default:
-        ASSERT(isInteger(value->type->kind()), "no other type kind allowed");
-        return new IntegerValue{value->type, down_cast<IntegerValue*>(value)->val};
-    }
-}
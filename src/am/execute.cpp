@@ -28,16 +28,21 @@ using am::Execute;
 #define CHECK_DESIGNATION_REGISTER() COMPILER_GUARANTEE(am.dsg_reg.entity != nullptr && am.dsg_reg.lvalue_type != nullptr, "entity or lvalue_type of designation register is null")
 #define CHECK_TYPE(expr) COMPILER_GUARANTEE(expr, "type constraint violation")
 
+template<bool verified>
 void Execute::designate(AbstractMachine& am, InstrInfo info)
 {
     auto id = info.getIdentifierID();
     if (id.isFuntion()) {
-        CHECK_ID(function, id.value(), am.static_info.functions.length());
+        if constexpr (!verified) {
+            CHECK_ID(function, id.value(), am.static_info.functions.length());
+        }
         am.dsg_reg.entity = &am.static_info.functions[id.value()];
     } else {
         auto& objects = id.isGlobal() ? am.static_info.static_objects
                                       : am.state.current_function().automatic_objects;
-        CHECK_ID(object, id.value(), objects.length());
+        if constexpr (!verified) {
+            CHECK_ID(object, id.value(), objects.length());
+        }
         am.dsg_reg.entity = objects[id.value()];
     }
     COMPILER_GUARANTEE(am.dsg_reg.entity != nullptr, "entity of designation register is null");
@@ -83,8 +88,7 @@ void Execute::read(AbstractMachine& am, InstrInfo info)
     }
     if (lvalue_type.kind() == Kind::function) {
         // lvalue conversion
-        auto ptr = new PointerValue{&type_manager.getPointer(lvalue_type), am.dsg_reg.entity, 0};
-        am.operand_stack.push(ValueBox{ptr});
+        am.operand_stack.push(ValueBox{PointerValue{&type_manager.getPointer(lvalue_type), am.dsg_reg.entity, 0}});
         return;
     }
     auto& obj = down_cast<Object&>(*am.dsg_reg.entity);
@@ -109,7 +113,7 @@ void Execute::read(AbstractMachine& am, InstrInfo info)
         const auto [qualifier, _] = peelQualify(*am.dsg_reg.lvalue_type);
         ASSERT(obj.sub_objects.length() > 0, "array object must have at least one element");
         auto& elem_t = addQualify(down_cast<const Array&>(lvalue_type).element, qualifier);
-        am.operand_stack.push(ValueBox{new PointerValue{&type_manager.getPointer(elem_t), obj.sub_objects[0], 0}});
+        am.operand_stack.push(ValueBox{PointerValue{&type_manager.getPointer(elem_t), obj.sub_objects[0], 0}});
         return;
     }
     Execute::attachTag(am, obj, volatile_access ? InnerID::newMutualExclude(info.getInnerID()) : InnerID::newCoexisting(info.getInnerID()));
@@ -166,47 +170,65 @@ void Execute::do_read(am::AbstractMachine& am)
     const auto [qualifier, _lvalue_type] = peelQualify(*am.dsg_reg.lvalue_type);
     // (For lambda)Captured structured bindings are a C++20 extension
     auto& lvalue_type = _lvalue_type;
-    auto value = [&]() -> Value* {
+    auto value = [&]() -> ValueBox {
         switch (lvalue_type.kind()) {
         case Kind::f32: {
-            auto tmp = am.memory.read32(obj.address);
             float val;
+            if (obj.host_address != nullptr) [[likely]] {
+                std::memcpy(&val, obj.host_address, 4);
+                return ValueBox{F32Value{val}};
+            }
+            auto tmp = am.memory.read32(obj.address);
             std::memcpy(&val, &tmp, 4);
-            return new F32Value{val};
+            return ValueBox{F32Value{val}};
         }
         case Kind::f64: {
-            auto tmp = am.memory.read64(obj.address);
             double val;
+            if (obj.host_address != nullptr) [[likely]] {
+                std::memcpy(&val, obj.host_address, 8);
+                return ValueBox{F64Value{val}};
+            }
+            auto tmp = am.memory.read64(obj.address);
             std::memcpy(&val, &tmp, 8);
-            return new F64Value{val};
+            return ValueBox{F64Value{val}};
         }
         case Kind::pointer: {
-            auto addr = am.memory.read64(obj.address);
-            auto offset = am.memory.read64(obj.address + 8);
+            uint64_t addr, offset;
+            if (obj.host_address != nullptr) [[likely]] {
+                std::memcpy(&addr, obj.host_address, 8);
+                std::memcpy(&offset, obj.host_address + 8, 8);
+            } else {
+                addr = am.memory.read64(obj.address);
+                offset = am.memory.read64(obj.address + 8);
+            }
             if (!am.isValidEntityAddress(addr)) {
-                return new DissociativePointerValue{&lvalue_type, addr + offset};
+                return ValueBox{DissociativePointerValue{&lvalue_type, addr + offset}};
             }
             auto ptr = reinterpret_cast<Entity*>(addr);
             if (!PointerValue::isValidOffset(&lvalue_type, ptr, offset)) {
-                return new DissociativePointerValue{&lvalue_type, addr + offset};
+                return ValueBox{DissociativePointerValue{&lvalue_type, addr + offset}};
             }
-            return new PointerValue{&lvalue_type, ptr, offset};
+            return ValueBox{PointerValue{&lvalue_type, ptr, offset}};
         }
         case Kind::struct_:
         case Kind::union_:
-            return new StructOrUnionValue{&lvalue_type, &obj};
+            return ValueBox{StructOrUnionValue{&lvalue_type, &obj}};
         default:
             ASSERT(isInteger(lvalue_type.kind()), "no other type kind could occur");
             ASSERT(am.dsg_reg.offset <= obj.size(), "invalid offset of designation register");
             uint64_t val = 0;
-            am.memory.read(reinterpret_cast<uint8_t*>(&val), obj.address + am.dsg_reg.offset, lvalue_type.size());
+            if (obj.host_address != nullptr && am.dsg_reg.offset + lvalue_type.size() <= obj.size()) [[likely]] {
+                std::memcpy(&val, obj.host_address + am.dsg_reg.offset, lvalue_type.size());
+            } else {
+                am.memory.read(reinterpret_cast<uint8_t*>(&val), obj.address + am.dsg_reg.offset, lvalue_type.size());
+            }
 #ifdef CAMI_TARGET_INFO_BIG_ENDIAN
             val >>= 64 - 8 * lvalue_type.size();
 #endif
-            return new IntegerValue{&lvalue_type, val};
+            return ValueBox{IntegerValue{&lvalue_type, val}};
         }
     }();
-    am.operand_stack.push({ValueBox{value}, {&obj, false}});
+    am.operand_stack.push({std::move(value), {&obj, false}});
 }
 
 void Execute::do_modify(am::AbstractMachine& am, ValueBox vb) // NOLINT
@@ -218,7 +240,11 @@ void Execute::do_modify(am::AbstractMachine& am, ValueBox vb) // NOLINT
         auto tmp = vb.get<F32Value>().f32();
         uint32_t val;
         std::memcpy(&val, &tmp, 4);
-        am.memory.write32(obj.address, val);
+        if (obj.host_address != nullptr) [[likely]] {
+            std::memcpy(obj.host_address, &val, 4);
+        } else {
+            am.memory.write32(obj.address, val);
+        }
         obj.status = Object::Status::well;
     }
         break;
@@ -226,7 +252,11 @@ void Execute::do_modify(am::AbstractMachine& am, ValueBox vb) // NOLINT
         auto tmp = vb.get<F64Value>().f64();
         uint64_t val;
         std::memcpy(&val, &tmp, 8);
-        am.memory.write64(obj.address, val);
+        if (obj.host_address != nullptr) [[likely]] {
+            std::memcpy(obj.host_address, &val, 8);
+        } else {
+            am.memory.write64(obj.address, val);
+        }
         obj.status = Object::Status::well;
     }
         break;
@@ -244,9 +274,14 @@ void Execute::do_modify(am::AbstractMachine& am, ValueBox vb) // NOLINT
         } else {
             ptr = 0;
         }
-        auto offset = vb.get<PointerValue>().getOffset();
-        am.memory.write64(obj.address, ptr);
-        am.memory.write64(obj.address + 8, offset);
+        uint64_t offset = vb.get<PointerValue>().getOffset();
+        if (obj.host_address != nullptr) [[likely]] {
+            std::memcpy(obj.host_address, &ptr, 8);
+            std::memcpy(obj.host_address + 8, &offset, 8);
+        } else {
+            am.memory.write64(obj.address, ptr);
+            am.memory.write64(obj.address + 8, offset);
+        }
         obj.status = Object::Status::well;
     }
         break;
@@ -275,11 +310,15 @@ void Execute::do_modify(am::AbstractMachine& am, ValueBox vb) // NOLINT
             return;
         }
 #ifdef CAMI_TARGET_INFO_LITTLE_ENDIAN
-        am.memory.write(obj.address + am.dsg_reg.offset, reinterpret_cast<uint8_t*>(&val), write_value_type.size());
+        auto* src = reinterpret_cast<uint8_t*>(&val);
 #else
-        am.memory.write(obj.address + am.dsg_reg.offset, reinterpret_cast<uint8_t*>(&val) + (8 - write_value_type.size()),
-                        write_value_type.size());
+        auto* src = reinterpret_cast<uint8_t*>(&val) + (8 - write_value_type.size());
 #endif
+        if (obj.host_address != nullptr && am.dsg_reg.offset + write_value_type.size() <= obj.size()) [[likely]] {
+            std::memcpy(obj.host_address + am.dsg_reg.offset, src, write_value_type.size());
+        } else {
+            am.memory.write(obj.address + am.dsg_reg.offset, src, write_value_type.size());
+        }
         obj.status = Object::Status::well;
     }
 }
@@ -301,19 +340,25 @@ void Execute::modifyPointerObjectInCharacterType(AbstractMachine& am, Object& ob
     obj.status = Object::Status::well;
 }
 
+template<bool verified>
 void Execute::enterBlock(AbstractMachine& am, InstrInfo info)
 {
-    do_enterBlock(am, info.getBlockID());
+    do_enterBlock<verified>(am, info.getBlockID());
 }
 
+template<bool verified>
 void Execute::do_enterBlock(AbstractMachine& am, uint32_t block_id)
 {
     auto& current_func = am.state.current_function();
     auto* static_info = current_func.static_info;
     current_func.blocks.push(block_id);
-    CHECK_ID(block, block_id, static_info->blocks.length());
+    if constexpr (!verified) {
+        CHECK_ID(block, block_id, static_info->blocks.length());
+    }
     for (const auto& item: static_info->blocks[block_id].obj_desc) {
-        CHECK_ID(object, item.id, current_func.automatic_objects.length());
+        if constexpr (!verified) {
+            CHECK_ID(object, item.id, current_func.automatic_objects.length());
+        }
         auto obj = am.object_manager.new_(item.name, item.type, am.state.frame_pointer + item.offset);
         if (item.init_data) {
             applyRecursively(*obj, [](auto& o) { o.status = Object::Status::well; });
@@ -323,41 +368,49 @@ void Execute::do_enterBlock(AbstractMachine& am, uint32_t block_id)
     }
 }
 
+template<bool verified>
 void Execute::leaveBlock(AbstractMachine& am)
 {
     auto& current_func = am.state.current_function();
     auto* static_info = current_func.static_info;
-    COMPILER_GUARANTEE(!current_func.blocks.empty(),
-                       "Instruction `lb` is executed while there's no block in current function");
+    if constexpr (!verified) {
+        COMPILER_GUARANTEE(!current_func.blocks.empty(),
+                           "Instruction `lb` is executed while there's no block in current function");
+    }
     auto block_id = current_func.blocks.top();
     current_func.blocks.pop();
     // leave block is implicitly treated as a full expression, because it destroys automatic object(s),
     //      which may indeterminate pointer object(s)
     current_func.full_expr_exec_cnt++;
     for (const auto& item: static_info->blocks[block_id].obj_desc) {
-        CHECK_ID(object, item.id, current_func.automatic_objects.length());
+        if constexpr (!verified) {
+            CHECK_ID(object, item.id, current_func.automatic_objects.length());
+        }
         auto obj = current_func.automatic_objects[item.id];
         am.object_manager.cleanup(obj, InnerID::newMutualExclude(0));
         current_func.automatic_objects[item.id] = nullptr;
     }
 }
 
+template<bool verified>
 void Execute::newObject(AbstractMachine& am, InstrInfo info)
 {
     static uint64_t cnt = 0;
     auto id = info.getTypeID();
-    CHECK_ID(type, id, am.static_info.types.length());
+    if constexpr (!verified) {
+        CHECK_ID(type, id, am.static_info.types.length());
+    }
     auto type = am.static_info.types[id];
     auto val = am.operand_stack.popDeterminateValue();
     CHECK_TYPE(isInteger(val->getType().kind()));
     auto num = val.get<IntegerValue>().uint64();
     if (num == 0) {
-        am.operand_stack.push(ValueBox{new PointerValue{type, nullptr, 0}});
+        am.operand_stack.push(ValueBox{PointerValue{type, nullptr, 0}});
         return;
     }
     auto obj = am.object_manager.new_("<heap>#"s + std::to_string(cnt++), type_manager.getArray(*type, num),
                                       am.heap_allocator->alloc(type->size() * num, type->align()));
-    am.operand_stack.push(ValueBox{new PointerValue{&type_manager.getPointer(*type), obj->sub_objects[0], 0}});
+    am.operand_stack.push(ValueBox{PointerValue{&type_manager.getPointer(*type), obj->sub_objects[0], 0}});
 }
 
 void Execute::deleteObject(AbstractMachine& am, InstrInfo info)
@@ -395,28 +448,33 @@ void Execute::fullExpression(AbstractMachine& am, InstrInfo info)
     cur_func.full_expr_exec_cnt++;
 }
 
+template<bool verified>
 void Execute::jump(AbstractMachine& am, InstrInfo info)
 {
     auto target_pc = am.state.pc + info.getOffset();
-    checkJumpAddr(am, target_pc);
+    if constexpr (!verified) {
+        checkJumpAddr(am, target_pc);
+    }
     am.state.pc = target_pc;
 }
 
+template<bool verified>
 void Execute::jumpIfSet(AbstractMachine& am, InstrInfo info)
 {
     auto flag = am.operand_stack.popDeterminateValue();
     CHECK_TYPE(isScalar(flag->getType().kind()));
     if (!flag.isZero()) {
-        jump(am, info);
+        jump<verified>(am, info);
     }
 }
 
+template<bool verified>
 void Execute::jumpIfNotSet(AbstractMachine& am, InstrInfo info)
 {
     auto flag = am.operand_stack.popDeterminateValue();
     CHECK_TYPE(isScalar(flag->getType().kind()));
     if (flag.isZero()) {
-        jump(am, info);
+        jump<verified>(am, info);
     }
 }
 
@@ -432,12 +490,20 @@ void Execute::call(AbstractMachine& am, InstrInfo info)
     if (!entity) {
         throw ConstraintViolationException{"call nullptr"};
     }
-    auto& ref_type = down_cast<const Pointer&>(func_ptr->getType()).referenced;
-    CHECK_TYPE(ref_type.kind() == Kind::function);
-    if (!isCompatible(ref_type, (*entity)->effective_type)) {
-        throw UBException{{UB::incompatible_func_call}, lib::format(
-                "Entity `${name}`(with type `${}`) is called by incompatible pointer type `${}`",
-                **entity, (*entity)->effective_type, func_ptr->getType())};
+    // the result of following checks only depends on pointer type and callee, which rarely change for one call site
+    auto& cache = callSiteCache(am);
+    if (cache.pointer_type == &func_ptr->getType() && cache.callee == *entity) [[likely]] {
+        am.state.call_site_cache_hit_cnt++;
+    } else {
+        am.state.call_site_cache_miss_cnt++;
+        auto& ref_type = down_cast<const Pointer&>(func_ptr->getType()).referenced;
+        CHECK_TYPE(ref_type.kind() == Kind::function);
+        if (!isCompatible(ref_type, (*entity)->effective_type)) {
+            throw UBException{{UB::incompatible_func_call}, lib::format(
+                    "Entity `${name}`(with type `${}`) is called by incompatible pointer type `${}`",
+                    **entity, (*entity)->effective_type, func_ptr->getType())};
+        }
+        cache = {&func_ptr->getType(), &down_cast<spd::Function&>(**entity)};
     }
     auto& func = down_cast<spd::Function&>(**entity);
     am.state.frame_pointer -= func.frame_size;
@@ -450,9 +516,13 @@ void Execute::call(AbstractMachine& am, InstrInfo info)
                           InnerID::newCoexisting(info.getInnerID())},
             static_cast<uint32_t>(&func - am.static_info.functions.data())
     };
-    am.state.call_stack.emplace_back(&func, am.state.pc, func.max_object_num, *context);
+    am.state.call_stack.emplace_back(&func, am.state.pc, am.state.frame_pointer, func.max_object_num, *context);
     am.state.pc = func.address;
-    do_enterBlock(am, 0);
+    if (func.verified) {
+        do_enterBlock<true>(am, 0);
+    } else {
+        do_enterBlock<false>(am, 0);
+    }
 }
 
 void Execute::indirectJump(AbstractMachine& am)
@@ -480,12 +550,15 @@ void Execute::ret(AbstractMachine& am)
 
 void Execute::pushUndefined(cami::am::AbstractMachine& am)
 {
-    am.operand_stack.push({ValueBox{new UndefinedValue{}}, {{}, true}});
+    am.operand_stack.push({ValueBox{UndefinedValue{}}, {{}, true}});
 }
 
+template<bool verified>
 void Execute::push(AbstractMachine& am, InstrInfo info)
 {
-    CHECK_ID(constant, info.getConstantID(), am.static_info.constants.length());
+    if constexpr (!verified) {
+        CHECK_ID(constant, info.getConstantID(), am.static_info.constants.length());
+    }
     am.operand_stack.push(am.static_info.constants[info.getConstantID()]);
 }
 
@@ -526,13 +599,21 @@ void Execute::address(AbstractMachine& am)
 {
     CHECK_DESIGNATION_REGISTER();
     am.operand_stack.push(ValueBox{
-            new PointerValue{&type_manager.getPointer(*am.dsg_reg.lvalue_type),
+            PointerValue{&type_manager.getPointer(*am.dsg_reg.lvalue_type),
                              am.dsg_reg.entity, am.dsg_reg.offset}});
 }
 
 void Execute::accessMember(AbstractMachine& am, const Entity* entity,
                            const ts::Type* _lvalue_type, uint32_t member_id)
 {
+    // the result of following checks only depends on effective type of entity and lvalue type,
+    //   which rarely change for one instruction
+    auto& cache = memberAccessCache(am);
+    if (cache.object_type == &entity->effective_type && cache.lvalue_type == _lvalue_type) [[likely]] {
+        am.dsg_reg.entity = down_cast<const Object&>(*entity).sub_objects[member_id];
+        am.dsg_reg.lvalue_type = cache.member_lvalue_type;
+        return;
+    }
     const auto [qualifier, lvalue_type] = peelQualify(*_lvalue_type);
     CHECK_TYPE(lvalue_type.kind() == Kind::struct_ || lvalue_type.kind() == Kind::union_);
     auto& obj_type = removeQualify(entity->effective_type);
@@ -567,6 +648,7 @@ void Execute::accessMember(AbstractMachine& am, const Entity* entity,
     }
     am.dsg_reg.entity = obj.sub_objects[member_id];
     am.dsg_reg.lvalue_type = &addQualify(*member_type, qualifier);
+    cache = {&entity->effective_type, _lvalue_type, member_type, am.dsg_reg.lvalue_type};
 }
 
 void Execute::basicModifyCheck(cami::am::AbstractMachine& am, bool ignore_const)
@@ -635,3 +717,17 @@ void Execute::checkJumpAddr(AbstractMachine& am, uint64_t target_pc)
         throw JumpOutOfBoundaryException{target_pc};
     }
 }
+
+#define INSTANTIATE_VERIFIED_VARIANTS(verified)                                     \
+    template void Execute::designate<verified>(AbstractMachine& am, InstrInfo info);    \
+    template void Execute::enterBlock<verified>(AbstractMachine& am, InstrInfo info);   \
+    template void Execute::leaveBlock<verified>(AbstractMachine& am);                   \
+    template void Execute::newObject<verified>(AbstractMachine& am, InstrInfo info);    \
+    template void Execute::jump<verified>(AbstractMachine& am, InstrInfo info);         \
+    template void Execute::jumpIfSet<verified>(AbstractMachine& am, InstrInfo info);    \
+    template void Execute::jumpIfNotSet<verified>(AbstractMachine& am, InstrInfo info); \
+    template void Execute::push<verified>(AbstractMachine& am, InstrInfo info)
+
+INSTANTIATE_VERIFIED_VARIANTS(false);
+INSTANTIATE_VERIFIED_VARIANTS(true);
+#undef INSTANTIATE_VERIFIED_VARIANTS
@@ -16,6 +16,9 @@
 
 #include <fetch_decode.h>
 #include <am.h>
+#include <exception.h>
+#include <array>
+#include <algorithm>
 
 using namespace cami;
 using am::FetchDecode;
@@ -24,8 +27,128 @@ using am::InstrInfo;
 using am::VirtualMemory;
 
 std::pair<Opcode, InstrInfo> FetchDecode::decode(AbstractMachine& am)
+{
+    am.state.executed_instr_cnt++;
+    auto offset = am.state.pc - am::layout::CODE_BASE;
+    if (offset < am.instructions.length()) [[likely]] {
+        const auto& instr = am.instructions[offset];
+        if (instr.length != 0) [[likely]] {
+            am.state.pc += instr.length;
+            return {instr.op, instr.info};
+        }
+    }
+    // out of code segment, truncated instruction or invalid opcode, let `decodeFromMemory` report the error
+    return FetchDecode::decodeFromMemory(am);
+}
+
+InstrInfo FetchDecode::decodeFollowing(AbstractMachine& am)
+{
+    // the following components of a superinstruction are always valid, see `FetchDecode::fuse`
+    am.state.executed_instr_cnt++;
+    const auto& instr = am.instructions[am.state.pc - am::layout::CODE_BASE];
+    am.state.pc += instr.length;
+    return instr.info;
+}
+
+lib::Array<am::DecodedInstr> FetchDecode::predecode(const lib::Array<uint8_t>& code)
+{
+    // every offset is decoded (rather than only the instruction boundaries) so that
+    //   the behavior of jumping into the middle of an instruction is kept unchanged
+    lib::Array<DecodedInstr> instructions(code.length());
+    for (size_t i = 0; i < code.length(); ++i) {
+        auto op = static_cast<Opcode>(code[i]);
+        InstrInfo extra_info{};
+        uint8_t length = 1;
+        if (FetchDecode::isSuperinstruction(op)) {
+            length = 0;
+        } else if (FetchDecode::hasExtraInfo(op)) {
+            if (i + 4 > code.length()) {
+                length = 0;
+            } else if (FetchDecode::isJump(op)) {
+                extra_info.offset = static_cast<int64_t>(lib::readI<3>(&code[i + 1]));
+                length = 4;
+            } else {
+                extra_info.id = lib::readU<3>(&code[i + 1]);
+                length = 4;
+            }
+        }
+        instructions.init(i, op, length, 0U, extra_info);
+    }
+    return instructions;
+}
+
+namespace {
+struct Superinstruction
+{
+    Opcode fused;
+    std::array<Opcode, 3> components;
+    size_t component_cnt;
+};
+
+// longer sequences should be placed first
+constexpr Superinstruction superinstructions[]{
+        {Opcode::fe_dsg_read,   {Opcode::fe, Opcode::dsg, Opcode::read},    3},
+        {Opcode::dsg_addr_call, {Opcode::dsg, Opcode::addr, Opcode::call},  3},
+        {Opcode::fe_dsg,        {Opcode::fe, Opcode::dsg},                  2},
+        {Opcode::dsg_read,      {Opcode::dsg, Opcode::read},                2},
+        {Opcode::dsg_addr,      {Opcode::dsg, Opcode::addr},                2},
+        {Opcode::dsg_mdf,       {Opcode::dsg, Opcode::mdf},                 2},
+        {Opcode::push_add,      {Opcode::push, Opcode::add},                2},
+        {Opcode::push_cast,     {Opcode::push, Opcode::cast},               2},
+};
+
+// return the length of matched sequence starting at `offset`, or 0 if not matched
+uint64_t match(const lib::Array<am::DecodedInstr>& instructions, uint64_t offset, uint64_t end,
+               const Superinstruction& superinstruction)
+{
+    auto cur = offset;
+    for (size_t i = 0; i < superinstruction.component_cnt; ++i) {
+        if (cur >= end || instructions[cur].length == 0 || instructions[cur].op != superinstruction.components[i]) {
+            return 0;
+        }
+        cur += instructions[cur].length;
+    }
+    return cur - offset;
+}
+} // anonymous namespace
+
+void FetchDecode::fuse(AbstractMachine& am)
+{
+    // only the opcode of the first component is rewritten, the records of other components are
+    //   kept unchanged, so that jumping into the middle of a superinstruction still works.
+    auto& instructions = am.instructions;
+    for (const auto& func: am.static_info.functions) {
+        auto offset = func.address - am::layout::CODE_BASE;
+        auto end = std::min(offset + func.code_size, instructions.length());
+        while (offset < end && instructions[offset].length != 0) {
+            uint64_t matched_len = 0;
+            for (const auto& item: superinstructions) {
+                if (matched_len = match(instructions, offset, end, item); matched_len != 0) {
+                    instructions[offset].op = item.fused;
+                    break;
+                }
+            }
+            offset += matched_len != 0 ? matched_len : instructions[offset].length;
+        }
+    }
+}
+
+Opcode FetchDecode::unfuse(Opcode op) noexcept
+{
+    for (const auto& item: superinstructions) {
+        if (item.fused == op) {
+            return item.components[0];
+        }
+    }
+    return op;
+}
+
+std::pair<Opcode, InstrInfo> FetchDecode::decodeFromMemory(AbstractMachine& am)
 {
     auto op = static_cast<Opcode>(am.memory.read8(am.state.pc));
+    if (FetchDecode::isSuperinstruction(op)) {
+        throw InvalidOpcodeException{static_cast<uint8_t>(op)};
+    }
     InstrInfo extra_info{};
     if (FetchDecode::hasExtraInfo(op)) {
         if (FetchDecode::isJump(op)) {
@@ -164,6 +164,14 @@ std::string Formatter::opcode(Opcode opcode)
             {Opcode::and_,  "and"sv},
             {Opcode::or_,   "or"sv},
             {Opcode::xor_,  "xor"sv},
+            {Opcode::fe_dsg,        "fe+dsg"sv},
+            {Opcode::dsg_read,      "dsg+read"sv},
+            {Opcode::dsg_addr,      "dsg+addr"sv},
+            {Opcode::dsg_mdf,       "dsg+mdf"sv},
+            {Opcode::push_add,      "push+add"sv},
+            {Opcode::push_cast,     "push+cast"sv},
+            {Opcode::fe_dsg_read,   "fe+dsg+read"sv},
+            {Opcode::dsg_addr_call, "dsg+addr+call"sv},
     };
     if (auto itr = map.find(opcode); itr != map.end()) {
         return std::string{itr->second};
@@ -83,6 +83,8 @@ void SimpleAllocator::dealloc(uint64_t addr, [[maybe_unused]] uint64_t size)
     }
     this->memory.write64(chunk_addr, chunk_len);
     this->memory.write64(chunk_addr + chunk_len - 8, chunk_len);
+    // only the cookies of a free chunk are accessed, so memory between them can be returned to OS
+    this->memory.releaseHeap(chunk_addr + 8, chunk_len - 16);
 }
 
 uint64_t SimpleAllocator::findNextAvailable(uint64_t addr)
@@ -0,0 +1,469 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include <jit.h>
+
+#ifdef CAMI_AM_JIT
+
+#include <am.h>
+#include <execute.h>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <sys/mman.h>
+
+using namespace cami;
+using am::JIT;
+using am::Opcode;
+using am::InstrInfo;
+using am::AbstractMachine;
+using am::Execute;
+
+namespace {
+// entry stub: `void entry(AbstractMachine* am, const void* native_address)`
+//   push rbx; mov rbx, rdi; jmp rsi
+constexpr uint8_t ENTRY_STUB[]{0x53, 0x48, 0x89, 0xfb, 0xff, 0xe6};
+// exit stub, placed at the beginning of each chunk of function code
+//   pop rbx; ret
+constexpr uint8_t EXIT_STUB[]{0x5b, 0xc3};
+constexpr uint64_t EXIT_OFFSET = 0;
+constexpr uint64_t NOT_COMPILED = std::numeric_limits<uint64_t>::max();
+
+class Emitter
+{
+    std::vector<uint8_t>& code;
+public:
+    explicit Emitter(std::vector<uint8_t>& code) : code(code) {}
+
+    void emit(std::initializer_list<uint8_t> bytes)
+    {
+        this->code.insert(this->code.end(), bytes);
+    }
+
+    void imm64(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i) {
+            this->code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    // emit rel32 operand referring to `target`, which is the last part of the instruction
+    void rel32(uint64_t target)
+    {
+        this->code.resize(this->code.size() + 4);
+        this->patch(this->code.size() - 4, target);
+    }
+
+    void patch(uint64_t position, uint64_t target)
+    {
+        auto rel = static_cast<int32_t>(static_cast<int64_t>(target) - static_cast<int64_t>(position + 4));
+        std::memcpy(&this->code[position], &rel, 4);
+    }
+
+    [[nodiscard]] uint64_t position() const noexcept
+    {
+        return this->code.size();
+    }
+
+    // mov rdi, rbx; mov rsi, instr; mov rdx, next_pc; mov rax, thunk; call rax
+    void callThunk(const void* thunk, const am::DecodedInstr& instr, uint64_t next_pc)
+    {
+        this->emit({0x48, 0x89, 0xdf});
+        this->emit({0x48, 0xbe});
+        this->imm64(reinterpret_cast<uintptr_t>(&instr));
+        this->emit({0x48, 0xba});
+        this->imm64(next_pc);
+        this->emit({0x48, 0xb8});
+        this->imm64(reinterpret_cast<uintptr_t>(thunk));
+        this->emit({0xff, 0xd0});
+    }
+
+    void jumpToExit()
+    {
+        this->emit({0xe9});
+        this->rel32(EXIT_OFFSET);
+    }
+};
+
+// return nullptr if failed
+uint8_t* allocateExecutable(const std::vector<uint8_t>& code)
+{
+    auto* buffer = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+        return nullptr;
+    }
+    std::memcpy(buffer, code.data(), code.size());
+    if (mprotect(buffer, code.size(), PROT_READ | PROT_EXEC) != 0) {
+        munmap(buffer, code.size());
+        return nullptr;
+    }
+    return static_cast<uint8_t*>(buffer);
+}
+
+void nop(AbstractMachine&) {}
+} // anonymous namespace
+
+JIT::~JIT()
+{
+    for (const auto& item: this->chunks) {
+        munmap(item.address, item.size);
+    }
+}
+
+void JIT::init(AbstractMachine& am)
+{
+    std::vector<uint8_t> entry(std::begin(ENTRY_STUB), std::end(ENTRY_STUB));
+    auto* address = allocateExecutable(entry);
+    if (address == nullptr) {
+        // run in interpreter only
+        return;
+    }
+    this->chunks.push_back({address, entry.size()});
+    this->native_addresses.assign(lib::Array<const void*>(am.instructions.length()));
+    std::fill(this->native_addresses.begin(), this->native_addresses.end(), nullptr);
+    this->backward_jump_counters.assign(lib::Array<uint64_t>(am.instructions.length()));
+    std::fill(this->backward_jump_counters.begin(), this->backward_jump_counters.end(), 0);
+    this->call_counters.assign(lib::Array<uint64_t>(am.static_info.functions.length()));
+    std::fill(this->call_counters.begin(), this->call_counters.end(), 0);
+    this->promoted.assign(am.static_info.functions.length(), false);
+    if (this->hot_loop_threshold == 0 || this->hot_function_threshold == 0) {
+        for (size_t i = 0; i < am.static_info.functions.length(); ++i) {
+            this->promote(am, i, 0, 0);
+        }
+    }
+}
+
+bool JIT::enter(AbstractMachine& am)
+{
+    auto* native_address = this->nativeAddress(am.state.pc);
+    if (native_address == nullptr) {
+        return false;
+    }
+    using Entry = void (*)(AbstractMachine*, const void*);
+    reinterpret_cast<Entry>(this->chunks.front().address)(&am, native_address);
+    if (this->pending_exception) {
+        std::rethrow_exception(std::exchange(this->pending_exception, nullptr));
+    }
+    return true;
+}
+
+bool JIT::onBackwardJump(AbstractMachine& am, uint64_t next_pc)
+{
+    auto site_offset = next_pc - 4 - layout::CODE_BASE;
+    if (site_offset >= this->backward_jump_counters.length()) {
+        return false;
+    }
+    auto count = ++this->backward_jump_counters[site_offset];
+    if (count < this->hot_loop_threshold) {
+        return false;
+    }
+    const auto* func = am.state.current_function().static_info;
+    auto index = static_cast<uint64_t>(func - am.static_info.functions.data());
+    // the bottom frame of call stack executes boot function with static info of entry function
+    if (this->promoted[index] || next_pc - 4 < func->address || next_pc > func->address + func->code_size) {
+        return false;
+    }
+    this->promote(am, index, next_pc - 4, count);
+    return this->hasNativeCode(am.state.pc);
+}
+
+void JIT::onCall(AbstractMachine& am)
+{
+    const auto* func = am.state.current_function().static_info;
+    auto index = static_cast<uint64_t>(func - am.static_info.functions.data());
+    if (this->promoted.empty() || this->promoted[index]) {
+        return;
+    }
+    auto count = ++this->call_counters[index];
+    if (count >= this->hot_function_threshold) {
+        this->promote(am, index, 0, count);
+    }
+}
+
+void JIT::promote(AbstractMachine& am, uint64_t function_index, uint64_t site_pc, uint64_t count)
+{
+    this->promoted[function_index] = true;
+    this->promotions.push_back({function_index, site_pc, count, am.state.executed_instr_cnt});
+    this->compileFunction(am, am.static_info.functions[function_index]);
+}
+
+std::string JIT::report(const AbstractMachine& am, size_t top_n) const
+{
+    const auto& functions = am.static_info.functions;
+    std::string result = lib::format("tiering: hot_loop_threshold = ${}, hot_function_threshold = ${}\n",
+                                     this->hot_loop_threshold, this->hot_function_threshold);
+    if (this->chunks.empty()) {
+        return result.append("JIT is unavailable, all functions are interpreted\n");
+    }
+    result.append(lib::format("promoted functions(${}/${}):\n", this->promotions.size(), functions.length()));
+    for (const auto& item: this->promotions) {
+        const auto& func = functions[item.function_index];
+        if (item.count == 0) {
+            result.append(lib::format("    ${}: eagerly\n", func.name));
+        } else if (item.site_pc != 0) {
+            result.append(lib::format("    ${}: hot loop at ${}+${}, ${} iterations, after ${} instructions\n",
+                                      func.name, func.name, item.site_pc - func.address, item.count,
+                                      item.executed_instr_cnt));
+        } else {
+            result.append(lib::format("    ${}: hot function, ${} calls, after ${} instructions\n",
+                                      func.name, item.count, item.executed_instr_cnt));
+        }
+    }
+    // counters stop increasing once the function is promoted
+    std::vector<std::pair<uint64_t, uint64_t>> sites; // (count, code offset)
+    for (size_t i = 0; i < this->backward_jump_counters.length(); ++i) {
+        if (this->backward_jump_counters[i] != 0) {
+            sites.emplace_back(this->backward_jump_counters[i], i);
+        }
+    }
+    auto n = std::min(top_n, sites.size());
+    std::partial_sort(sites.begin(), sites.begin() + static_cast<ptrdiff_t>(n), sites.end(), std::greater<>{});
+    result.append("hottest backward jumps in interpreter:\n");
+    for (size_t i = 0; i < n; ++i) {
+        auto pc = layout::CODE_BASE + sites[i].second;
+        auto func = std::find_if(functions.begin(), functions.end(), [pc](const spd::Function& f) {
+            return pc >= f.address && pc < f.address + f.code_size;
+        });
+        if (func != functions.end()) {
+            result.append(lib::format("    ${}+${}: ${}\n", func->name, pc - func->address, sites[i].first));
+        }
+    }
+    return result;
+}
+
+void JIT::compileFunction(AbstractMachine& am, const spd::Function& func)
+{
+    const auto& instructions = am.instructions;
+    auto begin = func.address - layout::CODE_BASE;
+    auto end = std::min(begin + func.code_size, instructions.length());
+    if (begin >= end) {
+        return;
+    }
+    // pre-decoded instructions may have been fused into superinstructions, which are compiled separately
+    const auto select = [&func](Opcode op, bool static_target) {
+        op = FetchDecode::unfuse(op);
+        return func.verified ? JIT::selectThunk<true>(op, static_target)
+                             : JIT::selectThunk<false>(op, static_target);
+    };
+    // instructions which have native code, i.e. valid targets of directly linked jumps
+    std::vector<bool> compiled(end - begin);
+    for (auto offset = begin; offset < end && instructions[offset].length != 0; offset += instructions[offset].length) {
+        compiled[offset - begin] = select(instructions[offset].op, false).kind != ThunkKind::unsupported;
+    }
+    std::vector<uint8_t> code(std::begin(EXIT_STUB), std::end(EXIT_STUB));
+    std::vector<uint64_t> native_offsets(end - begin, NOT_COMPILED);
+    Emitter emitter{code};
+    std::vector<std::pair<uint64_t, uint64_t>> fixups; // (position of rel32, code offset of jump target)
+    for (auto offset = begin; offset < end && instructions[offset].length != 0; offset += instructions[offset].length) {
+        const auto& instr = instructions[offset];
+        auto next_pc = layout::CODE_BASE + offset + instr.length;
+        auto target = offset + instr.length + instr.info.getOffset();
+        bool static_target = FetchDecode::isJump(instr.op) && target >= begin && target < end && compiled[target - begin];
+        auto thunk = select(instr.op, static_target);
+        if (thunk.kind == ThunkKind::unsupported) {
+            emitter.jumpToExit();
+            continue;
+        }
+        native_offsets[offset - begin] = emitter.position();
+        emitter.callThunk(thunk.address, instr, next_pc);
+        switch (thunk.kind) {
+        case ThunkKind::plain:
+            // test al, al; jz exit
+            emitter.emit({0x84, 0xc0, 0x0f, 0x84});
+            emitter.rel32(EXIT_OFFSET);
+            break;
+        case ThunkKind::branch:
+            // cmp eax, 1; je target; test eax, eax; jnz exit
+            emitter.emit({0x83, 0xf8, 0x01, 0x0f, 0x84});
+            fixups.emplace_back(emitter.position(), target);
+            emitter.rel32(0);
+            emitter.emit({0x85, 0xc0, 0x0f, 0x85});
+            emitter.rel32(EXIT_OFFSET);
+            break;
+        case ThunkKind::transfer:
+            // test rax, rax; jz exit; jmp rax
+            emitter.emit({0x48, 0x85, 0xc0, 0x0f, 0x84});
+            emitter.rel32(EXIT_OFFSET);
+            emitter.emit({0xff, 0xe0});
+            break;
+        default:
+            break;
+        }
+    }
+    // falling off the end of function or meeting an invalid instruction, let interpreter handle it
+    emitter.jumpToExit();
+    for (const auto& [position, target]: fixups) {
+        emitter.patch(position, native_offsets[target - begin]);
+    }
+    auto* address = allocateExecutable(code);
+    if (address == nullptr) {
+        // keep interpreting this function
+        return;
+    }
+    this->chunks.push_back({address, code.size()});
+    for (auto offset = begin; offset < end; ++offset) {
+        if (native_offsets[offset - begin] != NOT_COMPILED) {
+            this->native_addresses[offset] = address + native_offsets[offset - begin];
+        }
+    }
+}
+
+const void* JIT::nativeAddress(uint64_t pc) const noexcept
+{
+    auto offset = pc - layout::CODE_BASE;
+    return offset < this->native_addresses.length() ? this->native_addresses[offset] : nullptr;
+}
+
+template<bool verified>
+JIT::Thunk JIT::selectThunk(Opcode op, bool static_target) noexcept
+{
+#define PLAIN(handler) Thunk{ThunkKind::plain, reinterpret_cast<const void*>(&JIT::plainThunk<handler>)}
+#define TRANSFER(handler) Thunk{ThunkKind::transfer, reinterpret_cast<const void*>(&JIT::transferThunk<handler>)}
+#define JUMP(handler) (static_target ? Thunk{ThunkKind::branch, reinterpret_cast<const void*>(&JIT::branchThunk<handler>)} \
+                                     : TRANSFER(handler))
+    switch (op) {
+    case Opcode::nop:
+        return PLAIN(&nop);
+    case Opcode::dsg:
+        return PLAIN(&Execute::designate<verified>);
+    case Opcode::drf:
+        return PLAIN(&Execute::dereference);
+    case Opcode::read:
+        return PLAIN(&Execute::read);
+    case Opcode::mdf:
+        return PLAIN(&Execute::modify);
+    case Opcode::zero:
+        return PLAIN(&Execute::zero);
+    case Opcode::mdfi:
+        return PLAIN(&Execute::writeInit);
+    case Opcode::zeroi:
+        return PLAIN(&Execute::zeroInit);
+    case Opcode::eb:
+        return PLAIN(&Execute::enterBlock<verified>);
+    case Opcode::lb:
+        return PLAIN(&Execute::leaveBlock<verified>);
+    case Opcode::new_:
+        return PLAIN(&Execute::newObject<verified>);
+    case Opcode::del:
+        return PLAIN(&Execute::deleteObject);
+    case Opcode::fe:
+        return PLAIN(&Execute::fullExpression);
+    case Opcode::j:
+        return JUMP(&Execute::jump<verified>);
+    case Opcode::jst:
+        return JUMP(&Execute::jumpIfSet<verified>);
+    case Opcode::jnt:
+        return JUMP(&Execute::jumpIfNotSet<verified>);
+    case Opcode::call:
+        return TRANSFER(&JIT::call);
+    case Opcode::ij:
+        return TRANSFER(&Execute::indirectJump);
+    case Opcode::ret:
+        return TRANSFER(&Execute::ret);
+    case Opcode::pushu:
+        return PLAIN(&Execute::pushUndefined);
+    case Opcode::push:
+        return PLAIN(&Execute::push<verified>);
+    case Opcode::pop:
+        return PLAIN(&Execute::pop);
+    case Opcode::dup:
+        return PLAIN(&Execute::duplicate);
+    case Opcode::dot:
+        return PLAIN(&Execute::dot);
+    case Opcode::arrow:
+        return PLAIN(&Execute::arrow);
+    case Opcode::addr:
+        return PLAIN(&Execute::address);
+    case Opcode::cast:
+        return PLAIN(&Execute::cast<verified>);
+    default:
+        if (FetchDecode::isUnaryOperator(op)) {
+            return PLAIN(&Execute::unaryOperator);
+        } else if (FetchDecode::isBinaryOperator(op)) {
+            return PLAIN(&Execute::binaryOperator);
+        }
+        // `halt` and invalid opcodes
+        return Thunk{ThunkKind::unsupported, nullptr};
+    }
+#undef PLAIN
+#undef TRANSFER
+#undef JUMP
+}
+
+void JIT::call(AbstractMachine& am, InstrInfo info)
+{
+    Execute::call(am, info);
+    am.jit.onCall(am);
+}
+
+// do what the interpreter does for an instruction: update pc, then call the handler
+template<auto handler>
+void JIT::invoke(AbstractMachine& am, const DecodedInstr& instr, uint64_t next_pc)
+{
+    am.state.executed_instr_cnt++;
+    am.state.pc = next_pc;
+    if constexpr (std::is_invocable_v<decltype(handler), AbstractMachine&, InstrInfo>) {
+        handler(am, instr.info);
+    } else if constexpr (std::is_invocable_v<decltype(handler), AbstractMachine&, Opcode>) {
+        handler(am, instr.op);
+    } else {
+        handler(am);
+    }
+}
+
+// exceptions must not be propagated through native code, which has no unwind information
+template<auto handler>
+bool JIT::plainThunk(AbstractMachine& am, const DecodedInstr& instr, uint64_t next_pc) noexcept
+{
+    try {
+        JIT::invoke<handler>(am, instr, next_pc);
+        return true;
+    } catch (...) {
+        am.jit.pending_exception = std::current_exception();
+        return false;
+    }
+}
+
+// return 1 if jumped, 0 if not, -1 if an exception is thrown
+template<auto handler>
+int JIT::branchThunk(AbstractMachine& am, const DecodedInstr& instr, uint64_t next_pc) noexcept
+{
+    try {
+        JIT::invoke<handler>(am, instr, next_pc);
+        return am.state.pc != next_pc ? 1 : 0;
+    } catch (...) {
+        am.jit.pending_exception = std::current_exception();
+        return -1;
+    }
+}
+
+// return native address of new pc, or nullptr if there is none or an exception is thrown
+template<auto handler>
+const void* JIT::transferThunk(AbstractMachine& am, const DecodedInstr& instr, uint64_t next_pc) noexcept
+{
+    try {
+        JIT::invoke<handler>(am, instr, next_pc);
+        return am.jit.nativeAddress(am.state.pc);
+    } catch (...) {
+        am.jit.pending_exception = std::current_exception();
+        return nullptr;
+    }
+}
+
+#endif // CAMI_AM_JIT
@@ -0,0 +1,188 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include <monitor.h>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace cami;
+using namespace am;
+
+std::string OpcodeHistogram::report(size_t top_n) const
+{
+    using Item = std::pair<uint64_t, std::string>;
+    const auto append_top = [top_n](std::string& result, std::vector<Item>& items) {
+        auto n = std::min(top_n, items.size());
+        std::partial_sort(items.begin(), items.begin() + static_cast<ptrdiff_t>(n), items.end(),
+                          [](const Item& a, const Item& b) { return a.first > b.first; });
+        for (size_t i = 0; i < n; ++i) {
+            result.append(lib::format("    ${}: ${}\n", items[i].second, items[i].first));
+        }
+    };
+    std::vector<Item> items;
+    for (int i = 0; i < 256; ++i) {
+        for (int j = 0; j < 256; ++j) {
+            if (this->pairs[i][j] != 0) {
+                items.emplace_back(this->pairs[i][j],
+                                   lib::format("${}; ${}", static_cast<Opcode>(i), static_cast<Opcode>(j)));
+            }
+        }
+    }
+    std::string result = "opcode pairs:\n";
+    append_top(result, items);
+    items.clear();
+    for (const auto& [key, cnt]: this->triples) {
+        items.emplace_back(cnt, lib::format("${}; ${}; ${}", static_cast<Opcode>(key >> 16),
+                                            static_cast<Opcode>(key >> 8 & 0xff), static_cast<Opcode>(key & 0xff)));
+    }
+    result.append("opcode triples:\n");
+    append_top(result, items);
+    return result;
+}
+
+std::vector<uint8_t> OpcodeProfiler::sortedOpcodes() const
+{
+    std::vector<uint8_t> opcodes;
+    for (int i = 0; i < 256; ++i) {
+        if (this->records[i].count != 0) {
+            opcodes.push_back(static_cast<uint8_t>(i));
+        }
+    }
+    std::stable_sort(opcodes.begin(), opcodes.end(), [this](uint8_t a, uint8_t b) {
+        return this->records[a].time > this->records[b].time;
+    });
+    return opcodes;
+}
+
+std::string OpcodeProfiler::report() const
+{
+    uint64_t total_count = 0;
+    uint64_t total_time = 0;
+    for (const auto& item: this->records) {
+        total_count += item.count;
+        total_time += item.time;
+    }
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << "opcode profile (time in " << OpcodeProfiler::time_unit << "):\n"
+        << std::left << std::setw(12) << "opcode" << std::right << std::setw(16) << "count"
+        << std::setw(18) << "time" << std::setw(9) << "time%" << std::setw(14) << "time/instr"
+        << std::setw(14) << "stack depth" << '\n';
+    for (auto i: this->sortedOpcodes()) {
+        const auto& item = this->records[i];
+        auto count = static_cast<double>(item.count);
+        oss << std::left << std::setw(12) << lib::format("${}", static_cast<Opcode>(i)) << std::right
+            << std::setw(16) << item.count << std::setw(18) << item.time
+            << std::setw(9) << (total_time == 0 ? 0 : 100.0 * static_cast<double>(item.time) / static_cast<double>(total_time))
+            << std::setw(14) << static_cast<double>(item.time) / count
+            << std::setw(14) << static_cast<double>(item.stack_depth_sum) / count << '\n';
+    }
+    oss << std::left << std::setw(12) << "total" << std::right << std::setw(16) << total_count
+        << std::setw(18) << total_time << '\n';
+    return oss.str();
+}
+
+std::string OpcodeProfiler::toJson() const
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3) << "{\n  \"time_unit\": \"" << OpcodeProfiler::time_unit
+        << "\",\n  \"opcodes\": [";
+    bool first = true;
+    for (auto i: this->sortedOpcodes()) {
+        const auto& item = this->records[i];
+        auto count = static_cast<double>(item.count);
+        oss << (first ? "\n" : ",\n") << "    {\"opcode\": \"" << lib::format("${}", static_cast<Opcode>(i))
+            << "\", \"count\": " << item.count << ", \"time\": " << item.time
+            << ", \"average_stack_depth\": " << static_cast<double>(item.stack_depth_sum) / count << '}';
+        first = false;
+    }
+    oss << "\n  ]\n}\n";
+    return oss.str();
+}
+
+void SamplingProfiler::sample(const state::Global& state)
+{
+    this->sample_cnt++;
+    std::string stack;
+    auto& call_stack = state.call_stack;
+    for (size_t i = 0; i < call_stack.size(); ++i) {
+        // address inside the instruction being executed by this frame, i.e. the `call` instruction
+        //   for callers and the one just dispatched for the top frame
+        auto addr = (i + 1 == call_stack.size() ? state.pc : call_stack[i + 1].return_address) - 1;
+        auto func = call_stack[i].static_info;
+        if (!stack.empty()) {
+            stack.push_back(';');
+        }
+        // the bottom frame executes boot code, though its static info is the entry function
+        if (addr < func->address || addr >= func->address + func->code_size) {
+            stack.append("[boot]");
+            continue;
+        }
+        stack.append(func->name);
+        if (auto line = func->getSourceLine(addr)) {
+            stack.append(lib::format(":${}", *line));
+        }
+    }
+    this->stacks[stack]++;
+}
+
+std::string SamplingProfiler::collapsedStacks() const
+{
+    std::vector<std::pair<std::string_view, uint64_t>> items{this->stacks.begin(), this->stacks.end()};
+    std::sort(items.begin(), items.end());
+    std::string result;
+    for (const auto& [stack, cnt]: items) {
+        result.append(lib::format("${} ${}\n", stack, cnt));
+    }
+    return result;
+}
+
+uint64_t MemorySampler::peak() const noexcept
+{
+    uint64_t result = 0;
+    for (auto [_, rss]: this->samples) {
+        result = std::max(result, rss);
+    }
+    return result;
+}
+
+std::string MemorySampler::toCsv() const
+{
+    std::string result{"instructions,rss_bytes\n"};
+    for (auto [instr_cnt, rss]: this->samples) {
+        result.append(lib::format("${},${}\n", instr_cnt, rss));
+    }
+    return result;
+}
+
+uint64_t MemorySampler::residentSetSize() noexcept
+{
+#ifdef __linux__
+    // the second field of `/proc/self/statm` is resident set size in pages
+    std::ifstream statm{"/proc/self/statm"};
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    if (statm >> size >> resident) {
+        return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
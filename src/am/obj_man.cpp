@@ -54,7 +54,10 @@ Object* ObjectManager::new_(std::string name, const ts::Type& type, uint64_t add
         this->state.alloc = State::old_generation;
         return this->newLarge(std::move(name), type, address);
     }();
-    this->am.state.entities.emplace(obj->address, obj);
+    // automatic objects are indexed by frames of call stack
+    if (obj->address >= layout::HEAP_BASE && obj->address < layout::HEAP_BOUNDARY) {
+        this->am.state.heap_object_index.emplace_hint(this->am.state.heap_object_index.end(), obj->address, obj);
+    }
     return obj;
 }
 
@@ -65,7 +68,10 @@ Object* ObjectManager::newPermanent(std::string name, const ts::Type& type, uint
     this->state.alloc = State::permanent;
     auto* obj = this->createObject(type, address);
     obj->name = std::move(name);
-    this->am.state.entities.emplace(obj->address, obj);
+    auto& index = this->am.state.static_object_index;
+    index.insert(std::upper_bound(index.begin(), index.end(), obj->address, [](uint64_t addr, const Object* o) {
+        return addr < o->address;
+    }), obj);
     applyRecursively(*obj, [](Object& o) {
         o.status = Object::Status::well;
     });
@@ -116,18 +122,64 @@ void ObjectManager::cleanup(Object* object, InnerID inner_id)
             ASSERT(cnt == 1, "referenced object do not contains referencing object's reference");
         }
     });
-    [[maybe_unused]] auto cnt = this->am.state.entities.erase(object->address);
-    ASSERT(cnt == 1, "global entities do not contains object being cleanup");
+    if (object->address >= layout::HEAP_BASE && object->address < layout::HEAP_BOUNDARY) {
+        [[maybe_unused]] auto cnt = this->am.state.heap_object_index.erase(object->address);
+        ASSERT(cnt == 1, "heap object index do not contains object being cleanup");
+    }
+}
+
+lib::Optional<Object*> ObjectManager::findTopObject(uint64_t address) const
+{
+    const auto contains = [address](const Object* obj) {
+        return obj->address <= address && address - obj->address < obj->effective_type.size();
+    };
+    auto& state = this->am.state;
+    if (address >= layout::STACK_BASE && address < layout::STACK_BOUNDARY) {
+        // frames are pushed downward, i.e. `frame_pointer` of frames in call stack is descending
+        auto frame = std::partition_point(state.call_stack.begin(), state.call_stack.end(), [&](const state::Function& f) {
+            return f.frame_pointer > address;
+        });
+        if (frame == state.call_stack.end() || address - frame->frame_pointer >= frame->static_info->frame_size) {
+            return {};
+        }
+        // as for the other segments, take the object of the greatest address not greater than `address`
+        Object* found = nullptr;
+        for (Object* obj: frame->automatic_objects) {
+            if (obj != nullptr && obj->address <= address && (found == nullptr || obj->address > found->address)) {
+                found = obj;
+            }
+        }
+        if (found == nullptr || !contains(found)) {
+            return {};
+        }
+        return found;
+    }
+    if (address >= layout::HEAP_BASE && address < layout::HEAP_BOUNDARY) {
+        auto itr = state.heap_object_index.upper_bound(address);
+        if (itr == state.heap_object_index.begin() || !contains((--itr)->second)) {
+            return {};
+        }
+        return itr->second;
+    }
+    auto& index = state.static_object_index;
+    auto itr = std::upper_bound(index.begin(), index.end(), address, [](uint64_t addr, const Object* o) {
+        return addr < o->address;
+    });
+    if (itr == index.begin() || !contains(*(itr - 1))) {
+        return {};
+    }
+    return *(itr - 1);
 }
 
 Object* ObjectManager::createObject(const Type& type, uint64_t address) // NOLINT
 {
     auto obj = this->allocOneObject();
+    auto* host_address = this->am.memory.hostAddress(address, type.size(), type.align());
     if (isScalar(removeQualify(type).kind())) {
-        new(obj) Object{"", type, address, {}, {}};
+        new(obj) Object{"", type, address, host_address, {}, {}};
         return obj;
     }
-    new(obj) Object{"", type, address, {}, this->createSubObject(type, address)};
+    new(obj) Object{"", type, address, host_address, {}, this->createSubObject(type, address)};
     for (Object* item: obj->sub_objects) {
         item->super_object = obj;
     }
@@ -149,12 +201,10 @@ lib::Array<Object*> ObjectManager::createSubObject(const Type& _type, uint64_t a
         return sub_obj;
     } else if (type.kind() == Kind::struct_) {
         auto& t = down_cast<const Struct&>(type);
+        auto& offsets = t.offsets();
         lib::Array<Object*> sub_obj(t.members.length());
-        auto sub_obj_addr = address;
         for (size_t i = 0; i < sub_obj.length(); ++i) {
-            sub_obj_addr = lib::roundUp(sub_obj_addr, t.members[i]->align());
-            sub_obj[i] = this->createObject(addQualify(*t.members[i], qualifier), sub_obj_addr);
-            sub_obj_addr += t.members[i]->size();
+            sub_obj[i] = this->createObject(addQualify(*t.members[i], qualifier), address + offsets[i]);
         }
         return sub_obj;
     } else {
@@ -545,11 +595,9 @@ void ObjectManager::amRefRelocate(const std::map<Object*, Object*>& mapper)
             }
         }
     }
-    for (auto& item: this->am.state.entities) {
-        if (item.second->effective_type.kind() != Kind::function) {
-            if (auto itr = mapper.find(down_cast<Object*>(item.second)); itr != mapper.end()) {
-                item.second = itr->second;
-            }
+    for (auto& item: this->am.state.heap_object_index) {
+        if (auto itr = mapper.find(item.second); itr != mapper.end()) {
+            item.second = itr->second;
         }
     }
 }
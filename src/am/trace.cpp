@@ -17,6 +17,7 @@
 #include <set>
 #include <trace.h>
 #include <formatter.h>
+#include <am.h>
 #include <fetch_decode.h>
 #include <lib/list.h>
 
@@ -21,10 +21,12 @@
 #include <foundation/cross_platform.h>
 #include <exception.h>
 #include <cstring>
+#include <algorithm>
 #include <memory>
 #include <lib/format.h>
 #ifdef CAMI_TARGET_INFO_UNIX_LIKE
 #include <fcntl.h>
+#include <sys/mman.h>
 #elif defined(CAMI_TARGET_INFO_WINDOWS)
 #include <shlwapi.h>
 #include <fileapi.h>
@@ -36,6 +38,100 @@ using am::VirtualMemory;
 using ts::Kind;
 using ts::type_manager;
 
+VirtualMemory::Heap::~Heap()
+{
+    deletePageTable(this->page_table, 1);
+#ifdef CAMI_AM_FLAT_HEAP
+    if (this->flat_segment != nullptr) {
+        munmap(this->flat_segment, FLAT_SEGMENT_SIZE);
+    }
+#endif
+}
+
+#ifdef CAMI_AM_FLAT_HEAP
+uint8_t* VirtualMemory::Heap::reserveFlatSegment() noexcept
+{
+    auto* segment = mmap(nullptr, FLAT_SEGMENT_SIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (segment == MAP_FAILED) {
+        return nullptr;
+    }
+#if defined(CAMI_MEMORY_HEAP_ENABLE_TRANSPARENT_HUGE_PAGE) && defined(MADV_HUGEPAGE)
+    madvise(segment, FLAT_SEGMENT_SIZE, MADV_HUGEPAGE);
+#endif
+    return static_cast<uint8_t*>(segment);
+}
+#endif
+
+VirtualMemory::Stack::Stack()
+{
+#ifdef CAMI_TARGET_INFO_UNIX_LIKE
+    auto* base = mmap(nullptr, MAX_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        throw AMInitialFailedException{"cannot reserve memory for stack segment"};
+    }
+#elif defined(CAMI_TARGET_INFO_WINDOWS)
+    auto* base = VirtualAlloc(nullptr, MAX_SIZE, MEM_RESERVE, PAGE_NOACCESS);
+    if (base == nullptr) {
+        throw AMInitialFailedException{"cannot reserve memory for stack segment"};
+    }
+#endif
+    this->top = static_cast<uint8_t*>(base) + MAX_SIZE;
+}
+
+VirtualMemory::Stack::~Stack()
+{
+#ifdef CAMI_TARGET_INFO_UNIX_LIKE
+    munmap(this->top - MAX_SIZE, MAX_SIZE);
+#elif defined(CAMI_TARGET_INFO_WINDOWS)
+    VirtualFree(this->top - MAX_SIZE, 0, MEM_RELEASE);
+#endif
+}
+
+void VirtualMemory::Stack::commit(uint64_t new_size)
+{
+    if (new_size > MAX_SIZE) {
+        throw StackOverflowException{new_size, MAX_SIZE};
+    }
+    if (new_size <= this->committed) {
+        this->size = new_size;
+        return;
+    }
+    auto new_committed = std::min(lib::roundUp(new_size, GRANULARITY), MAX_SIZE);
+    auto* begin = this->top - new_committed;
+    auto len = new_committed - this->committed;
+#ifdef CAMI_TARGET_INFO_UNIX_LIKE
+    if (mprotect(begin, len, PROT_READ | PROT_WRITE) != 0) {
+        throw StackOverflowException{new_size, this->committed};
+    }
+#elif defined(CAMI_TARGET_INFO_WINDOWS)
+    if (VirtualAlloc(begin, len, MEM_COMMIT, PAGE_READWRITE) == nullptr) {
+        throw StackOverflowException{new_size, this->committed};
+    }
+#endif
+    this->committed = new_committed;
+    this->size = new_size;
+}
+
+void VirtualMemory::Stack::release(uint64_t used_size)
+{
+    // pages are returned to OS but remain accessible, content of which is unspecified afterwards(zero if returned),
+    //   since the valid stack segment never shrinks
+    auto keep = lib::roundUp(used_size, GRANULARITY);
+    auto resident_end = lib::roundUp(this->resident, GRANULARITY);
+    if (resident_end < keep + RELEASE_THRESHOLD) {
+        return;
+    }
+    auto* begin = this->top - resident_end;
+    auto len = resident_end - keep;
+#ifdef CAMI_TARGET_INFO_UNIX_LIKE
+    madvise(begin, len, MADV_DONTNEED);
+#elif defined(CAMI_TARGET_INFO_WINDOWS)
+    VirtualAlloc(begin, len, MEM_RESET, PAGE_READWRITE);
+#endif
+    this->resident = keep;
+}
+
 VirtualMemory::MMIO::MMIO(ObjectManager& om)
         : file_descriptor(new lib::SharedPtr<FileDescriptor>[FILE_DESCRIPTOR_MAX]{
         lib::makeShared<FileDescriptor>(STDIN_FD, MODE_READ_ONLY),
@@ -111,7 +207,7 @@ void VirtualMemory::zeroize(uint64_t addr, uint64_t len)
         return;
     }
     if (this->inValidStackSegment(addr, len)) {
-        std::memset(&this->stack[STACK_BOUNDARY - addr - len], 0, len);
+        std::memset(this->stack.hostAddress(addr), 0, len);
         return;
     }
     if (VirtualMemory::inValidHeapSegment(addr, len)) {
@@ -123,12 +219,14 @@ void VirtualMemory::zeroize(uint64_t addr, uint64_t len)
 void VirtualMemory::notifyStackPointer(uint64_t val)
 {
     auto stack_size = STACK_BOUNDARY - val;
-    if (stack_size > this->stack.size()) {
-        this->stack.resize(stack_size);
+    if (stack_size > this->stack.size) {
+        this->stack.commit(stack_size);
     }
-    // optimize: may call `this->stack.shrink_to_fit()` if real stack size is less than
-    //   the capacity of `this->stack`, but it should be noted that `shrink_to_fit` should be
-    //   delayed once, since a function may return a struct/union(the address of that will be pushed into operand stack).
+    this->stack.resident = std::max(this->stack.resident, stack_size);
+    // release is delayed once, since a function may return a struct/union
+    //   (the address of that will be pushed into operand stack), which lies in the frame just left
+    this->stack.release(std::max(stack_size, this->stack.last_used));
+    this->stack.last_used = stack_size;
 }
 
 void VirtualMemory::readCode(uint8_t* dest, uint64_t addr, uint64_t len) const
@@ -143,13 +241,17 @@ void VirtualMemory::readData(uint8_t* dest, uint64_t addr, uint64_t len) const
 
 void VirtualMemory::readStack(uint8_t* dest, uint64_t addr, uint64_t len) const
 {
-    for (size_t i = 0; i < len; ++i) {
-        dest[i] = this->stack[STACK_BOUNDARY - (addr + i) - 1];
-    }
+    std::memcpy(dest, this->stack.hostAddress(addr), len);
 }
 
 void VirtualMemory::readHeap(uint8_t* dest, uint64_t addr, uint64_t len) const
 {
+#ifdef CAMI_AM_FLAT_HEAP
+    if (auto* host = this->flatHeapAddress(addr, len); host != nullptr) [[likely]] {
+        std::memcpy(dest, host, len);
+        return;
+    }
+#endif
     auto roundUpAddr = lib::roundUp(addr, Heap::PAGE_SIZE);
     if (addr < roundUpAddr) {
         if (addr + len <= roundUpAddr) {
@@ -192,13 +294,17 @@ void VirtualMemory::writeData(uint64_t addr, const uint8_t* src, uint64_t len)
 
 void VirtualMemory::writeStack(uint64_t addr, const uint8_t* src, uint64_t len)
 {
-    for (size_t i = 0; i < len; ++i) {
-        this->stack[STACK_BOUNDARY - (addr + i) - 1] = src[i];
-    }
+    std::memcpy(this->stack.hostAddress(addr), src, len);
 }
 
 void VirtualMemory::writeHeap(uint64_t addr, const uint8_t* src, uint64_t len)
 {
+#ifdef CAMI_AM_FLAT_HEAP
+    if (auto* host = this->flatHeapAddressForWrite(addr, len); host != nullptr) [[likely]] {
+        std::memcpy(host, src, len);
+        return;
+    }
+#endif
     auto roundUpAddr = lib::roundUp(addr, Heap::PAGE_SIZE);
     if (addr < roundUpAddr) {
         if (addr + len <= roundUpAddr) {
@@ -223,6 +329,12 @@ void VirtualMemory::writeHeap(uint64_t addr, const uint8_t* src, uint64_t len)
 
 void VirtualMemory::zeroizeHeap(uint64_t addr, uint64_t len)
 {
+#ifdef CAMI_AM_FLAT_HEAP
+    if (auto* host = this->flatHeapAddressForWrite(addr, len); host != nullptr) [[likely]] {
+        std::memset(host, 0, len);
+        return;
+    }
+#endif
     auto roundUpAddr = lib::roundUp(addr, Heap::PAGE_SIZE);
     if (addr < roundUpAddr) {
         if (addr + len <= roundUpAddr) {
@@ -291,9 +403,17 @@ void VirtualMemory::writeMMIO(uint64_t addr, const uint8_t* src, uint64_t len) /
 void VirtualMemory::readPage(uint8_t* dest, uint64_t addr, uint64_t len) const
 {
     ASSERT(addr % Heap::PAGE_SIZE + len <= Heap::PAGE_SIZE, "precondition violation");
+#ifdef CAMI_AM_FLAT_HEAP
+    if (auto* host = this->flatHeapAddress(addr, len); host != nullptr) {
+        std::memcpy(dest, host, len);
+        return;
+    }
+#endif
     auto page = this->getPage(addr);
     if (!page) {
-        throw MemoryAccessException{addr, len, "read unallocated heap page"};
+        // never written or released
+        std::memset(dest, 0, len);
+        return;
     }
     std::memcpy(dest, (*page)->data + addr % Heap::PAGE_SIZE, len);
 }
@@ -301,6 +421,12 @@ void VirtualMemory::readPage(uint8_t* dest, uint64_t addr, uint64_t len) const
 void VirtualMemory::writePage(uint64_t addr, const uint8_t* src, uint64_t len)
 {
     ASSERT(addr % Heap::PAGE_SIZE + len <= Heap::PAGE_SIZE, "precondition violation");
+#ifdef CAMI_AM_FLAT_HEAP
+    if (auto* host = this->flatHeapAddressForWrite(addr, len); host != nullptr) {
+        std::memcpy(host, src, len);
+        return;
+    }
+#endif
     auto page = [&]() {
         if (auto pg = this->getPage(addr); pg) {
             return *pg;
@@ -313,6 +439,12 @@ void VirtualMemory::writePage(uint64_t addr, const uint8_t* src, uint64_t len)
 void VirtualMemory::zeroizePage(uint64_t addr, uint64_t len)
 {
     ASSERT(addr % Heap::PAGE_SIZE + len <= Heap::PAGE_SIZE, "precondition violation");
+#ifdef CAMI_AM_FLAT_HEAP
+    if (auto* host = this->flatHeapAddressForWrite(addr, len); host != nullptr) {
+        std::memset(host, 0, len);
+        return;
+    }
+#endif
     auto page = [&]() {
         if (auto pg = this->getPage(addr); pg) {
             return *pg;
@@ -324,19 +456,32 @@ void VirtualMemory::zeroizePage(uint64_t addr, uint64_t len)
 
 lib::Optional<VirtualMemory::Heap::Page*> VirtualMemory::getPage(uint64_t addr) const
 {
-    auto piece_size = (HEAP_BOUNDARY - HEAP_BASE) / Heap::PAGE_TABLE_ITEM_NUM;
-    addr -= HEAP_BASE;
+    auto page_number = (addr - HEAP_BASE) / Heap::PAGE_SIZE;
+    auto& entry = this->heap.tlb.entry(page_number);
+    if (entry.page_number == page_number) [[likely]] {
+        this->heap.tlb.hit_cnt++;
+        return entry.page;
+    }
+    this->heap.tlb.miss_cnt++;
+    auto page = this->walkPageTable(addr);
+    if (page) {
+        entry = {page_number, *page};
+    }
+    return page;
+}
+
+lib::Optional<VirtualMemory::Heap::Page*> VirtualMemory::walkPageTable(uint64_t addr) const
+{
+    auto page_number = (addr - HEAP_BASE) / Heap::PAGE_SIZE;
     auto page_table = this->heap.page_table;
-    for (size_t i = 0; i < Heap::PAGE_TABLE_LEVEL - 1; ++i) {
-        auto idx = addr / piece_size;
-        ASSERT(idx < Heap::PAGE_TABLE_ITEM_NUM, "");
-        addr %= piece_size;
+    for (size_t level = 1; level < Heap::PAGE_TABLE_LEVEL; ++level) {
+        auto idx = page_number / Heap::itemSpan(level) % Heap::PAGE_TABLE_ITEM_NUM;
         page_table = page_table->item[idx].sub_page_table;
         if (page_table == nullptr) {
             return {};
         }
     }
-    if (auto* page = page_table->item[addr / piece_size].page;page != nullptr) {
+    if (auto* page = page_table->item[page_number % Heap::PAGE_TABLE_ITEM_NUM].page;page != nullptr) {
         return page;
     }
     return {};
@@ -344,26 +489,91 @@ lib::Optional<VirtualMemory::Heap::Page*> VirtualMemory::getPage(uint64_t addr)
 
 VirtualMemory::Heap::Page* VirtualMemory::allocPage(uint64_t addr) const
 {
-    auto piece_size = (HEAP_BOUNDARY - HEAP_BASE) / Heap::PAGE_TABLE_ITEM_NUM;
-    addr -= HEAP_BASE;
+    auto page_number = (addr - HEAP_BASE) / Heap::PAGE_SIZE;
     auto page_table = this->heap.page_table;
-    for (size_t i = 0; i < Heap::PAGE_TABLE_LEVEL - 1; ++i) {
-        auto idx = addr / piece_size;
-        ASSERT(idx < Heap::PAGE_TABLE_ITEM_NUM, "");
-        addr %= piece_size;
+    for (size_t level = 1; level < Heap::PAGE_TABLE_LEVEL; ++level) {
+        auto idx = page_number / Heap::itemSpan(level) % Heap::PAGE_TABLE_ITEM_NUM;
         if (page_table->item[idx].sub_page_table == nullptr) {
             page_table->item[idx].sub_page_table = new Heap::PageTable{};
         }
         page_table = page_table->item[idx].sub_page_table;
     }
-    auto idx = addr / piece_size;
+    auto idx = page_number % Heap::PAGE_TABLE_ITEM_NUM;
     auto* page = page_table->item[idx].page;
     if (page == nullptr) {
         page = page_table->item[idx].page = new Heap::Page{};
+        this->heap.allocated_pages.insert(page_number);
     }
+    this->heap.tlb.entry(page_number) = {page_number, page};
     return page;
 }
 
+void VirtualMemory::releaseHeap(uint64_t addr, uint64_t len)
+{
+    ASSERT(inValidHeapSegment(addr, len), "precondition violation");
+    auto begin = lib::roundUp(addr - HEAP_BASE, Heap::PAGE_SIZE);
+    auto end = (addr - HEAP_BASE + len) / Heap::PAGE_SIZE * Heap::PAGE_SIZE;
+    if (begin >= end) {
+        return;
+    }
+#ifdef CAMI_AM_FLAT_HEAP
+    if (this->heap.flat_segment != nullptr) {
+        // memory beyond `flat_segment_used` has never been written, thus need not be released
+        auto used_end = lib::roundUp(this->heap.flat_segment_used, Heap::PAGE_SIZE);
+        auto flat_end = std::min(end, used_end);
+        if (begin < flat_end && flat_end - begin >= Heap::FLAT_RELEASE_THRESHOLD) {
+            madvise(this->heap.flat_segment + begin, flat_end - begin, MADV_DONTNEED);
+            if (flat_end == used_end) {
+                this->heap.flat_segment_used = begin;
+            }
+        }
+        begin = std::max(begin, Heap::FLAT_SEGMENT_SIZE);
+        if (begin >= end) {
+            return;
+        }
+    }
+#endif
+    auto& pages = this->heap.allocated_pages;
+    for (auto it = pages.lower_bound(begin / Heap::PAGE_SIZE); it != pages.end() && *it < end / Heap::PAGE_SIZE;) {
+        this->freePage(*it);
+        it = pages.erase(it);
+    }
+}
+
+uint8_t* VirtualMemory::hostAddress(uint64_t addr, uint64_t len, uint64_t align)
+{
+    // `read16`/`read32`/... reject unaligned access, which is not checked by host access
+    if (addr % align != 0 || addr >= UINT64_MAX - len) {
+        return nullptr;
+    }
+    if (this->inValidDataSegment(addr, len)) {
+        return addr < this->string_literal_end ? nullptr : this->data.data() + (addr - DATA_BASE);
+    }
+    if (this->inValidStackSegment(addr, len)) {
+        return this->stack.hostAddress(addr);
+    }
+#ifdef CAMI_AM_FLAT_HEAP
+    if (VirtualMemory::inValidHeapSegment(addr, len)) {
+        // the range may be written via the returned address without notifying `VirtualMemory`
+        return this->flatHeapAddressForWrite(addr, len);
+    }
+#endif
+    return nullptr;
+}
+
+void VirtualMemory::freePage(uint64_t page_number)
+{
+    auto page_table = this->heap.page_table;
+    for (size_t level = 1; level < Heap::PAGE_TABLE_LEVEL; ++level) {
+        page_table = page_table->item[page_number / Heap::itemSpan(level) % Heap::PAGE_TABLE_ITEM_NUM].sub_page_table;
+        ASSERT(page_table != nullptr, "freeing unallocated page");
+    }
+    auto& page = page_table->item[page_number % Heap::PAGE_TABLE_ITEM_NUM].page;
+    delete page;
+    page = nullptr;
+    this->heap.tlb.invalidate(page_number);
+}
+
 uint64_t VirtualMemory::do_open()
 {
     auto addr = this->mmio.content[MMIO::word0];
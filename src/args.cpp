@@ -105,13 +105,25 @@ see https://www.github.com/Liu-Xiangzhi/CAMI for github repository
     }
     auto sub_command = this->nextArg();
     if (sub_command == "run") {
-        std::cout << R"(cami run <bytecode_path>
+        std::cout << R"(cami run [--tiering-stats] [--profile] [--sample <interval>] [--rss <interval>] [--no-fold] <bytecode_path>
     load bytecode and launch abstract machine.
     <bytecode_path> can be both text form or binary form(not supported now), and can be object file
     or linked file. if <bytecode_path> is object file, abstract machine launcher will automatically
     find those dependent files, recursively, and link then together. Abstract machine actually only
     accept linked bytecode. Options of abstract machine is hard-coded now in order to facilitate
     implementation, and it will be runtime-configurable in next few versions.
+    --tiering-stats      print functions promoted by JIT and hottest loops after execution
+    --profile            run without JIT and superinstructions, print execution count, time and
+                         average operand stack depth of each opcode after execution, and write
+                         them to `cami_profile.json` in current directory as well
+    --sample <interval>  run without JIT, sample call stack of C program every <interval> instructions
+                         and write collapsed stacks of `function:line` frames to `cami_samples.folded`
+                         in current directory, which can be rendered by flame graph tools
+    --rss <interval>     run without JIT, sample resident set size of CAMI process every <interval>
+                         instructions and write `instructions,rss_bytes` lines to `cami_rss.csv`
+                         in current directory. Only supported on Linux
+    --no-fold            do not fold constant subexpressions when linking object files, which is
+                         useful for differential testing of the folding
 )";
     } else if (sub_command == "test_translation") {
         std::cout << R"(cami test_translation <bytecode_path>
@@ -142,7 +154,43 @@ without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
 void CommandLineParser::run()
 {
     this->result->sub_command = Argument::SubCommand::run;
-    this->result->run.file_name = this->nextArg("missing bytecode path");
+    this->result->run.tiering_stats = false;
+    this->result->run.profile = false;
+    this->result->run.sample_interval = 0;
+    this->result->run.rss_interval = 0;
+    this->result->run.fold_constant = true;
+    auto arg = this->nextArg("missing bytecode path");
+    while (true) {
+        if (arg == "--tiering-stats") {
+            this->result->run.tiering_stats = true;
+        } else if (arg == "--profile") {
+            this->result->run.profile = true;
+        } else if (arg == "--no-fold") {
+            this->result->run.fold_constant = false;
+        } else if (arg == "--sample") {
+            try {
+                this->result->run.sample_interval = std::stoull(std::string{this->nextArg("missing sample interval")});
+            } catch (const std::logic_error& e) {
+                throw CommandLineException{e.what()};
+            }
+            if (this->result->run.sample_interval == 0) {
+                throw CommandLineException{"sample interval should be positive"};
+            }
+        } else if (arg == "--rss") {
+            try {
+                this->result->run.rss_interval = std::stoull(std::string{this->nextArg("missing RSS sample interval")});
+            } catch (const std::logic_error& e) {
+                throw CommandLineException{e.what()};
+            }
+            if (this->result->run.rss_interval == 0) {
+                throw CommandLineException{"RSS sample interval should be positive"};
+            }
+        } else {
+            break;
+        }
+        arg = this->nextArg("missing bytecode path");
+    }
+    this->result->run.file_name = arg;
 }
 
 void CommandLineParser::test_translation()
@@ -209,6 +257,9 @@ void CommandLineParser::config()
     using namespace lib::literals;
     std::cout << std::boolalpha
               << "disable_compiler_guarantee_check: " << DEFINED(CAMI_DISABLE_COMPILER_GUARANTEE_CHECK) << '\n'
+              << "enable_threaded_dispatch: " << DEFINED(CAMI_ENABLE_THREADED_DISPATCH) << '\n'
+              << "enable_superinstruction: " << DEFINED(CAMI_ENABLE_SUPERINSTRUCTION) << '\n'
+              << "enable_jit: " << DEFINED(CAMI_ENABLE_JIT) << '\n'
               << "enable_auto_cache: " << DEFINED(CAMI_ENABLE_AUTO_CACHE) << '\n'
               << "cache_path: " << CAMI_CACHE_PATH << '\n'
               << "enable_log_file: " << DEFINED(CAMI_ENABLE_LOG_FILE) << '\n'
@@ -221,6 +272,8 @@ void CommandLineParser::config()
               << "log.color.info: " << CAMI_LOG_COLOR_INFO  "this color\033[0m\n"
               << "log.color.verbose: " << CAMI_LOG_COLOR_VERBOSE  "this color\033[0m\n"
               << "log.color.debug: " << CAMI_LOG_COLOR_DEBUG  "this color\033[0m\n"
+              << "jit.hot_loop_threshold: " << CAMI_JIT_HOT_LOOP_THRESHOLD << '\n'
+              << "jit.hot_function_threshold: " << CAMI_JIT_HOT_FUNCTION_THRESHOLD << '\n'
               << "object_manage.eden_size: " << readable(CAMI_OBJECT_MANAGE_EDEN_SIZE) << '\n'
               << "object_manage.old_generation_size: " << readable(CAMI_OBJECT_MANAGE_OLD_GENERATION_SIZE) << '\n'
               << "object_manage.large_object_threshold: " << readable(CAMI_OBJECT_MANAGE_LARGE_OBJECT_THRESHOLD) << '\n'
@@ -228,6 +281,10 @@ void CommandLineParser::config()
               << "memory.heap.page_size: " << readable(CAMI_MEMORY_HEAP_PAGE_SIZE) << '\n'
               << "memory.heap.page_table_level: " << readable(CAMI_MEMORY_HEAP_PAGE_TABLE_LEVEL) << '\n'
               << "memory.heap.allocator: " << STR(CAMI_MEMORY_HEAP_ALLOCATOR) << '\n'
+              << "memory.heap.enable_flat_segment: " << DEFINED(CAMI_MEMORY_HEAP_ENABLE_FLAT_SEGMENT) << '\n'
+              << "memory.heap.flat_segment_size: " << readable(CAMI_MEMORY_HEAP_FLAT_SEGMENT_SIZE) << '\n'
+              << "memory.heap.enable_transparent_huge_page: " << DEFINED(CAMI_MEMORY_HEAP_ENABLE_TRANSPARENT_HUGE_PAGE) << '\n'
+              << "memory.stack.max_size: " << readable(CAMI_MEMORY_STACK_MAX_SIZE) << '\n'
               << "memory.mmio.max_file: " << readable(CAMI_MEMORY_MMIO_MAX_FILE) << '\n'
               << "file_system.root: " << CAMI_FILE_SYSTEM_ROOT << std::endl;
 #undef DEFINED
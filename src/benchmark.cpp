@@ -0,0 +1,320 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+// Measures the throughput (executed abstract machine instructions per second) of CAMI.
+// usage: benchmark [-r <repeat>] [-h <top n>] [-o <n>] <file or directory>...
+//   directories are searched recursively for text bytecode files(*.tbc)
+//   `-h` prints the most frequent opcode pairs and triples instead of measuring throughput
+//   `-o` compares the hand-written signed overflow checks with the intrinsic-based ones on <n> random operand pairs
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <random>
+#include <am/am.h>
+#include <lib/overflow.h>
+#include <lib/utils.h>
+#include <launcher.h>
+
+using namespace cami;
+namespace fs = std::filesystem;
+
+struct Result
+{
+    std::string file_name;
+    uint64_t instr_cnt = 0;
+    uint64_t call_cache_hit = 0;
+    uint64_t call_cache_miss = 0;
+    uint64_t heap_tlb_hit = 0;
+    uint64_t heap_tlb_miss = 0;
+    bool flat_heap = false;
+    double seconds = 0;
+};
+
+Result benchmark(const fs::path& file, int repeat)
+{
+    auto cwd = fs::current_path();
+    // static linked files are specified relative to the directory of bytecode file
+    fs::current_path(file.parent_path());
+    Result result{file.string()};
+    for (int i = 0; i < repeat; ++i) {
+        am::AbstractMachine abstract_machine{Launcher::load(file.filename().string())};
+        auto begin = std::chrono::steady_clock::now();
+        abstract_machine.run();
+        auto end = std::chrono::steady_clock::now();
+        result.instr_cnt += abstract_machine.executedInstructionCount();
+        auto [hit, miss] = abstract_machine.callSiteCacheStatistics();
+        result.call_cache_hit += hit;
+        result.call_cache_miss += miss;
+        auto [tlb_hit, tlb_miss] = abstract_machine.heapTLBStatistics();
+        result.heap_tlb_hit += tlb_hit;
+        result.heap_tlb_miss += tlb_miss;
+        result.flat_heap = abstract_machine.usesFlatHeapSegment();
+        result.seconds += std::chrono::duration<double>(end - begin).count();
+    }
+    fs::current_path(cwd);
+    return result;
+}
+
+double hitRate(uint64_t hit, uint64_t miss)
+{
+    return hit + miss == 0 ? 0 : 100.0 * static_cast<double>(hit) / static_cast<double>(hit + miss);
+}
+
+// heap TLB only sees accesses beyond flat heap segment(mostly bookkeeping of heap allocator) if it's in use,
+//   thus its hit rate is meaningless then
+void printHeapTLB(bool flat_heap, uint64_t hit, uint64_t miss)
+{
+    std::cout << "heap TLB hit rate: ";
+    if (flat_heap) {
+        std::cout << "n/a (flat heap segment)";
+        return;
+    }
+    std::cout << hitRate(hit, miss) << "% (" << hit << " hits, " << miss << " misses, paged heap)";
+}
+
+void collect(const fs::path& path, std::vector<fs::path>& files)
+{
+    if (!fs::is_directory(path)) {
+        files.push_back(fs::absolute(path));
+        return;
+    }
+    for (const auto& entry: fs::recursive_directory_iterator(path)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".tbc") {
+            files.push_back(fs::absolute(entry.path()));
+        }
+    }
+}
+
+void histogram(const std::vector<fs::path>& files, size_t top_n)
+{
+    am::OpcodeHistogram histogram;
+    auto cwd = fs::current_path();
+    for (const auto& item: files) {
+        try {
+            fs::current_path(item.parent_path());
+            am::AbstractMachine abstract_machine{Launcher::load(item.filename().string())};
+            abstract_machine.run(histogram);
+        } catch (const std::exception& e) {
+            std::cerr << item.string() << ": " << e.what() << '\n';
+        }
+        fs::current_path(cwd);
+    }
+    std::cout << '\n' << histogram.report(top_n);
+}
+
+// the hand-written checks which `IntegerValue::add` and `IntegerValue::mul` used before `lib/overflow.h`
+bool manualAddOverflow(uint64_t lhs, uint64_t rhs, bool is_i32)
+{
+    auto res = lhs + rhs;
+    if (is_i32) {
+        return ((res >> 1) ^ res) & 0x8000'0000;
+    }
+    constexpr uint64_t MASK = ~(1ULL << 63);
+    auto msb_carry = ((lhs & MASK) + (rhs & MASK)) >> 63;
+    auto sb_carry = ((lhs >> 63) + (rhs >> 63) + msb_carry) >> 1;
+    return msb_carry ^ sb_carry;
+}
+
+bool manualMulOverflow(uint64_t lhs, uint64_t rhs, bool is_i32)
+{
+    const auto lhs_val = static_cast<int64_t>(lhs);
+    const auto rhs_val = static_cast<int64_t>(rhs);
+    if (is_i32) {
+        auto res = lhs_val * rhs_val;
+        return res > INT32_MAX || res < INT32_MIN;
+    }
+    const auto abs = [](int64_t v) -> uint64_t {
+        return v > 0 ? v : -static_cast<uint64_t>(v);
+    };
+    const uint64_t lhs_hi = abs(lhs_val) >> 32;
+    const uint64_t lhs_lo = abs(lhs_val) & 0xffff'ffff;
+    const uint64_t rhs_hi = abs(rhs_val) >> 32;
+    const uint64_t rhs_lo = abs(rhs_val) & 0xffff'ffff;
+    if (lhs_hi != 0 && rhs_hi != 0) {
+        return true;
+    }
+    const auto constant_factor = lhs_lo * rhs_lo;
+    const auto linear_factor = lhs_lo * rhs_hi + lhs_hi * rhs_lo;
+    if (linear_factor >> 32 != 0 || linear_factor + (constant_factor >> 32) > UINT32_MAX) {
+        return true;
+    }
+    auto res_abs = (linear_factor << 32) + constant_factor;
+    return (lhs_val > 0) == (rhs_val > 0) ? res_abs > INT64_MAX : res_abs > static_cast<uint64_t>(INT64_MIN);
+}
+
+bool intrinsicAddOverflow(uint64_t lhs, uint64_t rhs, bool is_i32)
+{
+    if (is_i32) {
+        int32_t res;
+        return lib::addOverflow(static_cast<int32_t>(lhs), static_cast<int32_t>(rhs), &res);
+    }
+    int64_t res;
+    return lib::addOverflow(static_cast<int64_t>(lhs), static_cast<int64_t>(rhs), &res);
+}
+
+bool intrinsicMulOverflow(uint64_t lhs, uint64_t rhs, bool is_i32)
+{
+    if (is_i32) {
+        int32_t res;
+        return lib::mulOverflow(static_cast<int32_t>(lhs), static_cast<int32_t>(rhs), &res);
+    }
+    int64_t res;
+    return lib::mulOverflow(static_cast<int64_t>(lhs), static_cast<int64_t>(rhs), &res);
+}
+
+template<typename Check>
+double timeOverflowCheck(const std::vector<std::pair<uint64_t, uint64_t>>& operands, size_t n, bool is_i32,
+                         Check check, uint64_t& overflow_cnt)
+{
+    overflow_cnt = 0;
+    auto begin = std::chrono::steady_clock::now();
+    // operands are reused so that the measurement is not bounded by memory bandwidth
+    for (size_t i = 0; i < n; i += operands.size()) {
+        for (const auto& [lhs, rhs]: operands) {
+            overflow_cnt += check(lhs, rhs, is_i32);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count() * 1e9 / static_cast<double>(n);
+}
+
+int overflowMicrobenchmark(size_t n)
+{
+    constexpr size_t operand_cnt = 4096;
+    n = lib::roundUp(n, operand_cnt);
+    std::mt19937_64 rng{0xca31};
+    // mix full-width operands with small ones so that both outcomes are exercised
+    auto random_operand = [&](bool is_i32) -> uint64_t {
+        auto val = static_cast<int64_t>(rng()) >> (is_i32 ? 32 + rng() % 32 : rng() % 64);
+        return static_cast<uint64_t>(val);
+    };
+    uint64_t mismatch = 0;
+    std::cout << std::fixed << std::setprecision(3);
+    for (bool is_i32: {true, false}) {
+        std::vector<std::pair<uint64_t, uint64_t>> operands(operand_cnt);
+        for (auto& item: operands) {
+            item = {random_operand(is_i32), random_operand(is_i32)};
+        }
+        for (const auto& [lhs, rhs]: operands) {
+            mismatch += manualAddOverflow(lhs, rhs, is_i32) != intrinsicAddOverflow(lhs, rhs, is_i32);
+            mismatch += manualMulOverflow(lhs, rhs, is_i32) != intrinsicMulOverflow(lhs, rhs, is_i32);
+        }
+        const char* width = is_i32 ? "i32" : "i64";
+        uint64_t manual_cnt;
+        uint64_t intrinsic_cnt;
+        auto manual_add = timeOverflowCheck(operands, n, is_i32, [](uint64_t lhs, uint64_t rhs, bool is_i32) {
+            return manualAddOverflow(lhs, rhs, is_i32);
+        }, manual_cnt);
+        auto intrinsic_add = timeOverflowCheck(operands, n, is_i32, [](uint64_t lhs, uint64_t rhs, bool is_i32) {
+            return intrinsicAddOverflow(lhs, rhs, is_i32);
+        }, intrinsic_cnt);
+        mismatch += manual_cnt != intrinsic_cnt;
+        std::cout << width << " add: " << manual_add << "ns(manual) vs " << intrinsic_add << "ns(intrinsic), "
+                  << manual_add / intrinsic_add << "x, " << intrinsic_cnt << " overflows\n";
+        auto manual_mul = timeOverflowCheck(operands, n, is_i32, [](uint64_t lhs, uint64_t rhs, bool is_i32) {
+            return manualMulOverflow(lhs, rhs, is_i32);
+        }, manual_cnt);
+        auto intrinsic_mul = timeOverflowCheck(operands, n, is_i32, [](uint64_t lhs, uint64_t rhs, bool is_i32) {
+            return intrinsicMulOverflow(lhs, rhs, is_i32);
+        }, intrinsic_cnt);
+        mismatch += manual_cnt != intrinsic_cnt;
+        std::cout << width << " mul: " << manual_mul << "ns(manual) vs " << intrinsic_mul << "ns(intrinsic), "
+                  << manual_mul / intrinsic_mul << "x, " << intrinsic_cnt << " overflows\n";
+    }
+    std::cout << "mismatched decisions: " << mismatch << std::endl;
+    return mismatch == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    int repeat = 10;
+    size_t top_n = 0;
+    size_t overflow_n = 0;
+    std::vector<fs::path> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeat = std::stoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "-h") == 0 && i + 1 < argc) {
+            top_n = std::stoul(argv[++i]);
+        } else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            overflow_n = std::stoul(argv[++i]);
+        } else {
+            collect(argv[i], files);
+        }
+    }
+    if (overflow_n != 0) {
+        return overflowMicrobenchmark(overflow_n);
+    }
+    if (files.empty()) {
+        std::cerr << "usage: " << argv[0] << " [-r <repeat>] [-h <top n>] [-o <n>] <file or directory>...\n";
+        return 1;
+    }
+    std::sort(files.begin(), files.end());
+    if (top_n != 0) {
+        histogram(files, top_n);
+        return 0;
+    }
+    std::vector<Result> results;
+    for (const auto& item: files) {
+        try {
+            results.push_back(benchmark(item, repeat));
+        } catch (const std::exception& e) {
+            std::cerr << item.string() << ": " << e.what() << '\n';
+        }
+    }
+    uint64_t total_instr = 0;
+    uint64_t total_call_hit = 0;
+    uint64_t total_call_miss = 0;
+    uint64_t total_tlb_hit = 0;
+    uint64_t total_tlb_miss = 0;
+    bool all_flat_heap = true;
+    double total_seconds = 0;
+    std::cout << "\ndispatch: "
+#if defined(CAMI_ENABLE_THREADED_DISPATCH) && defined(__GNUC__)
+              << "threaded"
+#else
+              << "switch"
+#endif
+              << ", repeat: " << repeat << '\n' << std::fixed << std::setprecision(3);
+    for (const auto& item: results) {
+        total_instr += item.instr_cnt;
+        total_seconds += item.seconds;
+        total_call_hit += item.call_cache_hit;
+        total_call_miss += item.call_cache_miss;
+        if (!item.flat_heap) {
+            total_tlb_hit += item.heap_tlb_hit;
+            total_tlb_miss += item.heap_tlb_miss;
+            all_flat_heap = false;
+        }
+        std::cout << item.file_name << ": " << item.instr_cnt / repeat << " instructions, "
+                  << item.instr_cnt / item.seconds / 1e6 << " MIPS, call cache hit rate: "
+                  << hitRate(item.call_cache_hit, item.call_cache_miss) << "%, ";
+        printHeapTLB(item.flat_heap, item.heap_tlb_hit, item.heap_tlb_miss);
+        std::cout << '\n';
+    }
+    std::cout << "total: " << total_instr << " instructions in " << total_seconds << "s, "
+              << total_instr / total_seconds / 1e6 << " MIPS, call cache hit rate: "
+              << hitRate(total_call_hit, total_call_miss) << "%, ";
+    // files using flat heap segment are excluded
+    printHeapTLB(all_flat_heap, total_tlb_hit, total_tlb_miss);
+    std::cout << std::endl;
+    return 0;
+}
@@ -103,25 +103,34 @@ size_t Function::hash() const noexcept
     return murmurhash3(hashes, 0x9abc);
 }
 
-size_t Struct::size() const noexcept
+void Struct::doComputeLayout() const noexcept
 {
+    lib::Array<size_t> offsets(this->members.length());
+    lib::Array<size_t> ends(this->members.length());
     size_t offset = 0;
-    for (const Type* item: this->members) {
-        offset = lib::roundUp(offset, item->align()) + item->size();
+    size_t max_align = 1;
+    for (size_t i = 0; i < this->members.length(); ++i) {
+        auto align = this->members[i]->align();
+        if (align > max_align) {
+            max_align = align;
+        }
+        offset = lib::roundUp(offset, align);
+        offsets[i] = offset;
+        offset += this->members[i]->size();
+        ends[i] = offset;
     }
-    return lib::roundUp(offset, this->align());
+    this->member_offsets.assign(std::move(offsets));
+    this->member_ends.assign(std::move(ends));
+    this->size_ = lib::roundUp(offset, max_align);
+    this->align_ = max_align;
+    this->layout_generation = this->current_layout_generation;
 }
 
-size_t Struct::align() const noexcept
+size_t Struct::memberIndexAt(size_t offset) const noexcept
 {
-    size_t max = 1;
-    for (const Type* item: this->members) {
-        auto align = item->align();
-        if (align > max) {
-            max = align;
-        }
-    }
-    return max;
+    this->computeLayout();
+    auto ends = this->member_ends.data();
+    return std::upper_bound(ends, ends + this->member_ends.length(), offset) - ends;
 }
 
 size_t Union::size() const noexcept
@@ -240,11 +240,13 @@ void MemoryManager::createStruct(std::string name, lib::Array<const Type*> membe
         //   views the string deleted at line 232
         this->struct_mapper.erase(name);
         area->~Struct();
-        new(area) Struct{std::move(name), std::move(members)};
+        new(area) Struct{std::move(name), std::move(members), this->layout_generation};
     } else {
-        area = this->struct_area.alloc(std::move(name), std::move(members));
+        area = this->struct_area.alloc(std::move(name), std::move(members), this->layout_generation);
     }
     this->struct_mapper.insert({area->name, area});
+    // layout of a struct depends on that of its members, which may be the struct just (re)defined
+    ++this->layout_generation;
 }
 
 void MemoryManager::createUnion(std::string name, lib::Array<const Type*> members)
@@ -260,6 +262,7 @@ void MemoryManager::createUnion(std::string name, lib::Array<const Type*> member
         area = this->union_area.alloc(std::move(name), std::move(members));
     }
     this->union_mapper.insert({area->name, area});
+    ++this->layout_generation;
 }
 
 const Struct& MemoryManager::declareStruct(std::string name)
@@ -267,7 +270,7 @@ const Struct& MemoryManager::declareStruct(std::string name)
     if (auto itr = this->struct_mapper.find(name);itr != this->struct_mapper.end()) {
         return *itr->second;
     }
-    auto area = this->struct_area.alloc(std::move(name), lib::Array<const Type*>{});
+    auto area = this->struct_area.alloc(std::move(name), lib::Array<const Type*>{}, this->layout_generation);
     this->struct_mapper.insert({area->name, area});
     return *area;
 }
@@ -17,10 +17,13 @@
 #include <launcher.h>
 #include <string_view>
 #include <queue>
+#include <iostream>
+#include <fstream>
 #include <am/am.h>
 #include <foundation/exception.h>
 #include <translate/pipe.h>
 #include <translate/linker.h>
+#include <translate/verifier.h>
 
 using namespace cami;
 using std::operator ""sv;
@@ -43,7 +46,35 @@ bool endWith(std::string_view sv, std::string_view suffix)
 }
 }
 
-void Launcher::launch(std::string_view file_name, FileType file_type)
+void Launcher::launch(std::string_view file_name, const LaunchOption& option, FileType file_type)
+{
+    am::AbstractMachine abstract_machine{Launcher::load(file_name, file_type, option.fold_constant)};
+    if (option.profile) {
+        am::OpcodeProfiler profiler;
+        abstract_machine.run(profiler);
+        std::cerr << profiler.report()
+                  << lib::format("max operand stack depth: ${}\n", abstract_machine.maxOperandStackDepth());
+        std::ofstream{"cami_profile.json"} << profiler.toJson();
+    } else if (option.sample_interval != 0) {
+        am::SamplingProfiler profiler{option.sample_interval};
+        abstract_machine.run(profiler);
+        std::ofstream{"cami_samples.folded"} << profiler.collapsedStacks();
+        std::cerr << lib::format("${} samples written to cami_samples.folded\n", profiler.sampleCount());
+    } else if (option.rss_interval != 0) {
+        am::MemorySampler sampler{option.rss_interval};
+        abstract_machine.run(sampler);
+        std::ofstream{"cami_rss.csv"} << sampler.toCsv();
+        std::cerr << lib::format("${} samples written to cami_rss.csv, peak RSS: ${} bytes\n",
+                                 sampler.sampleCount(), sampler.peak());
+    } else {
+        abstract_machine.run();
+    }
+    if (option.tiering_stats) {
+        std::cerr << abstract_machine.tieringReport(10);
+    }
+}
+
+std::unique_ptr<LinkedMBC> Launcher::load(std::string_view file_name, FileType file_type, bool fold_constant)
 {
     if (file_type == FileType::detect) {
         file_type = Launcher::detectFileType(file_name);
@@ -53,10 +84,11 @@ void Launcher::launch(std::string_view file_name, FileType file_type)
         throw std::runtime_error{"bytecode of `shared_object` type is not supported yet"};
     }
     if (mbc->attribute.type == MBC::Type::object_file) {
-        mbc = Launcher::linkFile(down_cast<std::unique_ptr<UnlinkedMBC>>(std::move(mbc)));
+        mbc = Launcher::linkFile(down_cast<std::unique_ptr<UnlinkedMBC>>(std::move(mbc)), fold_constant);
     }
-    am::AbstractMachine abstract_machine{down_cast<std::unique_ptr<LinkedMBC>>(std::move(mbc))};
-    abstract_machine.run();
+    auto linked_mbc = down_cast<std::unique_ptr<LinkedMBC>>(std::move(mbc));
+    Verifier::verify(*linked_mbc);
+    return linked_mbc;
 }
 
 FileType Launcher::detectFileType(std::string_view file_name)
@@ -80,7 +112,7 @@ std::unique_ptr<tr::MBC> Launcher::loadFile(std::string_view file_name, bool tex
     }
 }
 
-std::unique_ptr<LinkedMBC> Launcher::linkFile(std::unique_ptr<tr::UnlinkedMBC> mbc)
+std::unique_ptr<LinkedMBC> Launcher::linkFile(std::unique_ptr<tr::UnlinkedMBC> mbc, bool fold_constant)
 {
     std::queue<std::string> queue;
     for (const auto& item: mbc->attribute.static_links) {
@@ -108,6 +140,6 @@ std::unique_ptr<LinkedMBC> Launcher::linkFile(std::unique_ptr<tr::UnlinkedMBC> m
     for (auto& item: loaded_files) {
         mbcs[cnt++] = std::move(item.second);
     }
-    auto linked_mbc = Linker::link(std::move(mbcs), {MBC::Type::executable});
+    auto linked_mbc = Linker::link(std::move(mbcs), {MBC::Type::executable, fold_constant});
     return down_cast<std::unique_ptr<LinkedMBC>>(std::move(linked_mbc));
 }
@@ -43,7 +43,9 @@ void cami_main(int argc, char* argv[])
     case Argument::SubCommand::none:
         return;
     case Argument::SubCommand::run:
-        Launcher::launch(argument.run.file_name);
+        Launcher::launch(argument.run.file_name, {argument.run.tiering_stats, argument.run.profile,
+                                                    argument.run.sample_interval, argument.run.rss_interval,
+                                                    argument.run.fold_constant});
         return;
     case Argument::SubCommand::test_translation: {
         using namespace tr;
@@ -52,7 +54,8 @@ void cami_main(int argc, char* argv[])
         if (mbc->attribute.type == MBC::Type::object_file) {
             std::vector<std::unique_ptr<UnlinkedMBC>> mbcs{};
             mbcs.push_back(down_cast<std::unique_ptr<UnlinkedMBC>>(std::move(mbc)));
-            mbc = Linker::link(std::move(mbcs), {MBC::Type::executable});
+            // keep the code as written so that deassembled output can be compared with the input
+            mbc = Linker::link(std::move(mbcs), {MBC::Type::executable, false});
         }
         mbc | deassemble | output_name;
     }
@@ -0,0 +1,356 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include <constant_folder.h>
+#include <am/fetch_decode.h>
+#include <am/binary_kernel.h>
+#include <foundation/type/helper.h>
+#include <foundation/value.h>
+#include <lib/utils.h>
+#include <lib/format.h>
+#include <optional>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+
+using namespace cami;
+using namespace tr;
+using namespace ts;
+using am::Opcode;
+using am::FetchDecode;
+
+namespace {
+using Constant = std::pair<const Type*, uint64_t>;
+
+std::string constantSymbol(const Constant& constant)
+{
+    return lib::format("<${}; ${}>", *constant.first, constant.second);
+}
+
+ValueBox toValue(const Constant& constant)
+{
+    auto [type, value] = constant;
+    ASSERT(isArithmetic(type->kind()), "precondition violation");
+    if (type->kind() == Kind::f32) {
+        float val = 0;
+        std::memcpy(&val, &value, 4);
+        return ValueBox{F32Value{val}};
+    }
+    if (type->kind() == Kind::f64) {
+        double val = 0;
+        std::memcpy(&val, &value, 8);
+        return ValueBox{F64Value{val}};
+    }
+    return ValueBox{IntegerValue{type, value}};
+}
+
+Constant toConstant(const ValueBox& vb)
+{
+    auto& type = vb->getType();
+    uint64_t value = 0;
+    if (type.kind() == Kind::f32) {
+        auto val = vb.get<F32Value>().f32();
+        std::memcpy(&value, &val, 4);
+    } else if (type.kind() == Kind::f64) {
+        auto val = vb.get<F64Value>().f64();
+        std::memcpy(&value, &val, 8);
+    } else {
+        value = vb.get<IntegerValue>().uint64();
+    }
+    return {&type, value};
+}
+
+// mirrors `Execute::binaryOperator` for arithmetic operands
+std::optional<Constant> evalBinary(Opcode op, const Constant& lhs_constant, const Constant& rhs_constant)
+{
+    using namespace am;
+    auto lhs_kind = lhs_constant.first->kind();
+    auto rhs_kind = rhs_constant.first->kind();
+    if (!isArithmetic(lhs_kind) || !isArithmetic(rhs_kind)) {
+        return {};
+    }
+    auto integer_only = op == Opcode::mod || op == Opcode::ls || op == Opcode::rs ||
+                        op == Opcode::and_ || op == Opcode::or_ || op == Opcode::xor_;
+    if (integer_only && (!isInteger(lhs_kind) || !isInteger(rhs_kind))) {
+        return {};
+    }
+    try {
+        auto lhs = toValue(lhs_constant);
+        auto rhs = toValue(rhs_constant);
+        if (BinaryOperatorKernel::apply(op, lhs, rhs)) {
+            return toConstant(lhs);
+        }
+        switch (op) {
+        case Opcode::add:
+            lhs += rhs;
+            break;
+        case Opcode::sub:
+            lhs -= rhs;
+            break;
+        case Opcode::mul:
+            lhs *= rhs;
+            break;
+        case Opcode::div:
+            lhs /= rhs;
+            break;
+        case Opcode::mod:
+            lhs %= rhs;
+            break;
+        case Opcode::ls:
+            lhs <<= rhs;
+            break;
+        case Opcode::rs:
+            lhs >>= rhs;
+            break;
+        case Opcode::sl:
+            lhs = std::move(lhs) < std::move(rhs);
+            break;
+        case Opcode::sle:
+            lhs = std::move(lhs) <= std::move(rhs);
+            break;
+        case Opcode::sg:
+            lhs = std::move(lhs) > std::move(rhs);
+            break;
+        case Opcode::sge:
+            lhs = std::move(lhs) >= std::move(rhs);
+            break;
+        case Opcode::seq:
+            lhs = std::move(lhs) == std::move(rhs);
+            break;
+        case Opcode::sne:
+            lhs = std::move(lhs) != std::move(rhs);
+            break;
+        case Opcode::and_:
+            lhs &= rhs;
+            break;
+        case Opcode::or_:
+            lhs |= rhs;
+            break;
+        case Opcode::xor_:
+            lhs ^= rhs;
+            break;
+        default:
+            return {};
+        }
+        return toConstant(lhs);
+    } catch (const std::exception&) {
+        // keep the operation so that the exception is raised at run time
+        return {};
+    }
+}
+
+// mirrors `Execute::unaryOperator` for arithmetic operand
+std::optional<Constant> evalUnary(Opcode op, const Constant& constant)
+{
+    auto kind = constant.first->kind();
+    if (!isArithmetic(kind) || (op == Opcode::cpl && !isInteger(kind))) {
+        return {};
+    }
+    try {
+        auto operand = toValue(constant);
+        switch (op) {
+        case Opcode::pos:
+            operand.inplacePositive();
+            break;
+        case Opcode::neg:
+            operand.inplaceNegation();
+            break;
+        case Opcode::cpl:
+            operand.inplaceComplement();
+            break;
+        case Opcode::not_:
+            operand = !operand;
+            break;
+        default:
+            return {};
+        }
+        return toConstant(operand);
+    } catch (const std::exception&) {
+        return {};
+    }
+}
+
+// mirrors `Execute::cast` for arithmetic operand and arithmetic target type
+std::optional<Constant> evalCast(const Type& target, const Constant& constant)
+{
+    auto& type = removeQualify(target);
+    if (!isArithmetic(type.kind()) || !isArithmetic(constant.first->kind())) {
+        return {};
+    }
+    try {
+        auto operand = toValue(constant);
+        operand.castTo(type);
+        return toConstant(operand);
+    } catch (const std::exception&) {
+        return {};
+    }
+}
+
+struct Instruction
+{
+    uint64_t offset; // offset in original code, folded instructions take the offset of the first one
+    Opcode op;
+    uint64_t length;
+    std::optional<Constant> constant; // set for `push` of constant
+    const std::string* symbol; // relocation symbol, nullptr if there is none
+};
+} // anonymous namespace
+
+void ConstantFolder::fold(UnlinkedMBC& bytecode)
+{
+    for (auto& func: bytecode.functions) {
+        ConstantFolder::foldFunction(bytecode, *func);
+    }
+}
+
+bool ConstantFolder::foldFunction(UnlinkedMBC& bytecode, UnlinkedMBC::Function& func)
+{
+    const auto& code = func.code;
+    std::map<uint64_t, const std::string*> relocate;
+    for (const auto& item: func.relocate) {
+        relocate.emplace(item.instr_offset, &item.symbol);
+    }
+    std::map<std::string, Constant> constants;
+    for (const auto& item: bytecode.constants) {
+        constants.emplace(constantSymbol(item), item);
+    }
+    std::map<std::string, const Type*> types;
+    for (const auto* item: bytecode.types) {
+        types.emplace(lib::format("#${}", *item), item);
+    }
+    // decode, give up if the code is not well-formed, since folding must not change its behavior
+    std::vector<Instruction> instructions;
+    std::set<uint64_t> boundaries;
+    std::set<uint64_t> jump_targets;
+    for (uint64_t pc = 0; pc < code.size();) {
+        auto op = static_cast<Opcode>(code[pc]);
+        if (op == Opcode::ij || FetchDecode::isSuperinstruction(op)) {
+            return false;
+        }
+        uint64_t length = FetchDecode::hasExtraInfo(op) ? 4 : 1;
+        if (pc + length > code.size()) {
+            return false;
+        }
+        if (FetchDecode::isJump(op)) {
+            jump_targets.insert(pc + 4 + lib::readI<3>(&code[pc + 1]));
+        }
+        auto itr = relocate.find(pc);
+        instructions.push_back({pc, op, length, {}, itr == relocate.end() ? nullptr : itr->second});
+        boundaries.insert(pc);
+        pc += length;
+    }
+    for (auto target: jump_targets) {
+        if (target != code.size() && boundaries.find(target) == boundaries.end()) {
+            return false;
+        }
+    }
+    // fold
+    bool folded = false;
+    std::vector<Instruction> result;
+    auto mergeable = [&](const Instruction& instr) {
+        return jump_targets.find(instr.offset) == jump_targets.end();
+    };
+    for (auto& instr: instructions) {
+        if (instr.op == Opcode::push && instr.symbol != nullptr) {
+            if (auto itr = constants.find(*instr.symbol); itr != constants.end()) {
+                instr.constant = itr->second;
+            }
+            result.push_back(instr);
+            continue;
+        }
+        std::optional<Constant> constant;
+        size_t operand_cnt = 0;
+        if (FetchDecode::isBinaryOperator(instr.op) && result.size() >= 2 && result.back().constant &&
+            result[result.size() - 2].constant && mergeable(result.back()) && mergeable(instr)) {
+            constant = evalBinary(instr.op, *result[result.size() - 2].constant, *result.back().constant);
+            operand_cnt = 2;
+        } else if (FetchDecode::isUnaryOperator(instr.op) && !result.empty() && result.back().constant &&
+                   mergeable(instr)) {
+            constant = evalUnary(instr.op, *result.back().constant);
+            operand_cnt = 1;
+        } else if (instr.op == Opcode::cast && instr.symbol != nullptr && !result.empty() &&
+                   result.back().constant && mergeable(instr)) {
+            if (auto itr = types.find(*instr.symbol); itr != types.end()) {
+                constant = evalCast(*itr->second, *result.back().constant);
+            }
+            operand_cnt = 1;
+        }
+        if (!constant) {
+            result.push_back(instr);
+            continue;
+        }
+        auto offset = result[result.size() - operand_cnt].offset;
+        result.resize(result.size() - operand_cnt);
+        auto [itr, inserted] = constants.emplace(constantSymbol(*constant), *constant);
+        if (inserted) {
+            bytecode.constants.push_back(*constant);
+        }
+        result.push_back({offset, Opcode::push, 4, constant, &itr->first});
+        folded = true;
+    }
+    if (!folded) {
+        return false;
+    }
+    // offsets in original code are mapped to the start of the instruction covering them
+    std::vector<uint64_t> new_offsets;
+    uint64_t new_size = 0;
+    for (const auto& instr: result) {
+        new_offsets.push_back(new_size);
+        new_size += instr.length;
+    }
+    auto map = [&](uint64_t offset) -> uint64_t {
+        if (offset >= code.size()) {
+            return new_size + (offset - code.size());
+        }
+        auto itr = std::upper_bound(result.begin(), result.end(), offset, [](uint64_t a, const Instruction& b) {
+            return a < b.offset;
+        });
+        return itr == result.begin() ? 0 : new_offsets[itr - result.begin() - 1];
+    };
+    std::vector<uint8_t> new_code;
+    new_code.reserve(new_size);
+    std::vector<UnlinkedMBC::RelocateEntry> new_relocate;
+    for (size_t i = 0; i < result.size(); ++i) {
+        const auto& instr = result[i];
+        auto pc = new_offsets[i];
+        if (instr.symbol != nullptr) {
+            new_relocate.emplace_back(pc, *instr.symbol);
+        }
+        if (instr.constant) {
+            new_code.insert(new_code.end(), {static_cast<uint8_t>(Opcode::push), 0xff, 0xff, 0xff});
+            continue;
+        }
+        new_code.insert(new_code.end(), code.begin() + static_cast<int64_t>(instr.offset),
+                        code.begin() + static_cast<int64_t>(instr.offset + instr.length));
+        if (FetchDecode::isJump(instr.op)) {
+            auto target = instr.offset + 4 + lib::readI<3>(&code[instr.offset + 1]);
+            lib::write<3>(&new_code[pc + 1], map(target) - (pc + 4));
+        }
+    }
+    std::vector<am::spd::SourceCodeLocator::Item> new_locator;
+    for (const auto& [addr, len, line]: func.func_locator.data) {
+        auto begin = map(addr);
+        auto end = map(addr + len);
+        if (end > begin) {
+            new_locator.push_back({begin, end - begin, line});
+        }
+    }
+    func.code = std::move(new_code);
+    func.relocate = std::move(new_relocate);
+    func.func_locator.data = std::move(new_locator);
+    return true;
+}
@@ -15,6 +15,7 @@
  ******************************************************************************/
 
 #include <linker.h>
+#include <constant_folder.h>
 #include <exception.h>
 #include <lib/utils.h>
 #include <lib/assert.h>
@@ -24,6 +25,7 @@
 #include <am/spd.h>
 #include <set>
 #include <map>
+#include <algorithm>
 #include <cstring>
 
 using namespace cami;
@@ -323,9 +325,43 @@ ObjectLayout arrangeObject(std::vector<std::unique_ptr<UnlinkedMBC::StaticObject
     return {string_literal_cnt, string_literal_cnt + data_cnt, string_literal_cnt + data_cnt + bss_cnt};
 }
 
+std::string constantSymbol(const std::pair<const ts::Type*, uint64_t>& constant)
+{
+    return lib::format("<${}; ${}>", *constant.first, constant.second);
+}
+
+// constants referenced by more instructions come first, so that the frequently pushed ones
+//   share the leading cache lines of the constant pool
+void arrangeConstant(UnlinkedMBC& unlinked_mbc)
+{
+    std::map<std::string, uint64_t> reference_cnt;
+    for (const auto& func: unlinked_mbc.functions) {
+        for (const auto& [offset, symbol]: func->relocate) {
+            reference_cnt[symbol]++;
+        }
+    }
+    auto& constants = unlinked_mbc.constants;
+    std::vector<std::pair<uint64_t, size_t>> order;
+    order.reserve(constants.size());
+    for (size_t i = 0; i < constants.size(); ++i) {
+        auto itr = reference_cnt.find(constantSymbol(constants[i]));
+        order.emplace_back(itr == reference_cnt.end() ? 0 : itr->second, i);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+    std::vector<std::pair<const ts::Type*, uint64_t>> arranged;
+    arranged.reserve(constants.size());
+    for (const auto& [cnt, idx]: order) {
+        arranged.push_back(constants[idx]);
+    }
+    constants = std::move(arranged);
+}
+
 ObjectLayout arrange(UnlinkedMBC& unlinked_mbc)
 {
     arrangeFunction(unlinked_mbc.functions);
+    arrangeConstant(unlinked_mbc);
     return arrangeObject(unlinked_mbc.objects);
 }
 
@@ -336,7 +372,7 @@ void relocate(UnlinkedMBC& unlinked_mbc, const uint64_t static_object_cnt)
         sym_map.emplace(lib::format("#${}", *unlinked_mbc.types[i]), i);
     }
     for (size_t i = 0; i < unlinked_mbc.constants.size(); ++i) {
-        sym_map.emplace(lib::format("<${}; ${}>", *unlinked_mbc.constants[i].first, unlinked_mbc.constants[i].second), i);
+        sym_map.emplace(constantSymbol(unlinked_mbc.constants[i]), i);
     }
     for (size_t i = 0; i < unlinked_mbc.functions.size(); ++i) {
         if (!sym_map.emplace(unlinked_mbc.functions[i]->name, InstrInfo::IdentifierId::fromFunctionIndex(i)).second) {
@@ -374,23 +410,23 @@ lib::Array<ValueBox> makeConstants(lib::Slice<const std::pair<const ts::Type*, u
         case Kind::f32: {
             float val = 0;
             std::memcpy(&val, &value, 4);
-            result.init(i, new F32Value{val});
+            result.init(i, F32Value{val});
             break;
         }
         case Kind::f64: {
             double val = 0;
             std::memcpy(&val, &value, 8);
-            result.init(i, new F64Value{val});
+            result.init(i, F64Value{val});
             break;
         }
         case Kind::null:
-            result.init(i, new NullValue{});
+            result.init(i, NullValue{});
             break;
         default:
             if (!isInteger(type->kind())) {
                 throw CannotMakeConstantException{*type};
             }
-            result.init(i, new IntegerValue{type, value});
+            result.init(i, IntegerValue{type, value});
         }
     }
     return result;
@@ -522,6 +558,9 @@ std::unique_ptr<MBC> Linker::link(std::vector<std::unique_ptr<UnlinkedMBC>> mbcs
     if (option.type == MBC::Type::executable) {
         insertBootFunction(*unlinked_mbc);
     }
+    if (option.fold_constant) {
+        ConstantFolder::fold(*unlinked_mbc);
+    }
     auto arrange_result = arrange(*unlinked_mbc);
     relocate(*unlinked_mbc, arrange_result.staticObjectCnt());
     return makeLinkedMBC(std::move(unlinked_mbc), option, arrange_result);
@@ -0,0 +1,297 @@
+/*******************************************************************************
+ * Copyright (c) 2024. Liu Xiangzhi
+ * This file is part of CAMI.
+ *
+ * CAMI is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 2 of the License, or any later version.
+ *
+ * CAMI is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with CAMI.
+ * If not, see <https://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include <verifier.h>
+#include <am/fetch_decode.h>
+#include <am/spd.h>
+#include <foundation/type/def.h>
+#include <lib/utils.h>
+#include <lib/downcast.h>
+#include <vector>
+#include <queue>
+
+using namespace cami;
+using namespace tr;
+using am::Opcode;
+using am::FetchDecode;
+using am::InstrInfo;
+using am::spd::Function;
+
+namespace {
+// abstract state before executing certain instruction
+struct State
+{
+    static constexpr int64_t UNKNOWN = -1;
+    int64_t stack_depth = UNKNOWN; // UNKNOWN means that the instruction is not reached yet
+    int64_t block_depth = 0;
+    int64_t dsg_func = UNKNOWN; // index of function designated by designation register
+    int64_t top_func = UNKNOWN; // index of function referenced by pointer at the top of operand stack
+
+    [[nodiscard]] bool reached() const noexcept
+    {
+        return this->stack_depth != UNKNOWN;
+    }
+};
+
+struct Instruction
+{
+    Opcode op;
+    uint32_t id;
+    int64_t offset;
+    uint64_t length;
+};
+
+bool decode(const uint8_t* code, uint64_t code_size, uint64_t pc, Instruction& instr)
+{
+    instr.op = static_cast<Opcode>(code[pc]);
+    instr.id = 0;
+    instr.offset = 0;
+    instr.length = 1;
+    if (FetchDecode::isSuperinstruction(instr.op)) {
+        return false;
+    }
+    if (FetchDecode::hasExtraInfo(instr.op)) {
+        if (pc + 4 > code_size) {
+            return false;
+        }
+        instr.id = lib::readU<3>(&code[pc + 1]);
+        instr.offset = static_cast<int64_t>(lib::readI<3>(&code[pc + 1]));
+        instr.length = 4;
+    }
+    return true;
+}
+
+const ts::Function& functionType(const Function& func)
+{
+    return down_cast<const ts::Function&>(func.effective_type);
+}
+
+int64_t returnValueCnt(const ts::Function& type)
+{
+    return type.returned.kind() == ts::Kind::void_ ? 0 : 1;
+}
+} // anonymous namespace
+
+void Verifier::verify(LinkedMBC& bytecode)
+{
+    for (auto& func: bytecode.functions) {
+        func.verified = Verifier::verifyFunction(bytecode, func, func);
+    }
+    // abstract machine starts executing the beginning of code segment(i.e. boot function) within the frame of
+    //   entry function, which determines which variant of handlers is used, thus boot function must also be
+    //   verified against blocks and objects of entry function
+    if (bytecode.attribute.entry == nullptr) {
+        return;
+    }
+    auto& entry = bytecode.functions[bytecode.attribute.entry - bytecode.functions.data()];
+    for (const auto& func: bytecode.functions) {
+        if (func.address == 0 && &func != &entry && !Verifier::verifyFunction(bytecode, func, entry)) {
+            entry.verified = false;
+        }
+    }
+}
+
+bool Verifier::verifyFunction(const LinkedMBC& bytecode, const Function& func, // NOLINT(readability-function-cognitive-complexity)
+                              const Function& frame)
+{
+    if (func.address > bytecode.code.length() || func.code_size > bytecode.code.length() - func.address ||
+        func.code_size == 0 || frame.blocks.length() == 0) {
+        return false;
+    }
+    for (const auto& block: frame.blocks) {
+        for (const auto& item: block.obj_desc) {
+            if (item.id >= frame.max_object_num) {
+                return false;
+            }
+        }
+    }
+    const uint8_t* code = bytecode.code.data() + func.address;
+    const uint64_t code_size = func.code_size;
+    // decode linearly to find out instruction boundaries
+    std::vector<Instruction> instructions;
+    std::vector<int64_t> instr_index(code_size, -1); // map from code offset to index of `instructions`
+    for (uint64_t pc = 0; pc < code_size;) {
+        Instruction instr{};
+        if (!decode(code, code_size, pc, instr)) {
+            return false;
+        }
+        instr_index[pc] = static_cast<int64_t>(instructions.size());
+        instructions.push_back(instr);
+        pc += instr.length;
+    }
+    const auto in_range = [](uint64_t id, uint64_t size) { return id < size; };
+    std::vector<State> states(instructions.size());
+    std::vector<uint64_t> offsets(instructions.size());
+    for (uint64_t pc = 0, i = 0; i < instructions.size(); pc += instructions[i++].length) {
+        offsets[i] = pc;
+    }
+    std::queue<size_t> worklist;
+    // merge `state` into the state of instruction starting at code offset `target`
+    const auto flow_to = [&](int64_t target, const State& state) {
+        if (target < 0 || static_cast<uint64_t>(target) >= code_size || instr_index[target] < 0) {
+            return false;
+        }
+        auto& old = states[instr_index[target]];
+        if (!old.reached()) {
+            old = state;
+            worklist.push(instr_index[target]);
+            return true;
+        }
+        if (old.stack_depth != state.stack_depth || old.block_depth != state.block_depth) {
+            return false;
+        }
+        if (old.dsg_func != state.dsg_func || old.top_func != state.top_func) {
+            if (old.dsg_func != state.dsg_func) {
+                old.dsg_func = State::UNKNOWN;
+            }
+            if (old.top_func != state.top_func) {
+                old.top_func = State::UNKNOWN;
+            }
+            worklist.push(instr_index[target]);
+        }
+        return true;
+    };
+    auto& self_type = functionType(func);
+    flow_to(0, {static_cast<int64_t>(self_type.params.length()), 1, State::UNKNOWN, State::UNKNOWN});
+    while (!worklist.empty()) {
+        auto idx = worklist.front();
+        worklist.pop();
+        const auto& instr = instructions[idx];
+        auto state = states[idx];
+        auto next_pc = static_cast<int64_t>(offsets[idx] + instr.length);
+        // pop `pop_cnt` values then push `push_cnt` values
+        const auto apply = [&state](int64_t pop_cnt, int64_t push_cnt) {
+            if (state.stack_depth < pop_cnt) {
+                return false;
+            }
+            state.stack_depth += push_cnt - pop_cnt;
+            if (pop_cnt != 0 || push_cnt != 0) {
+                state.top_func = State::UNKNOWN;
+            }
+            return true;
+        };
+        bool ok = true;
+        bool fall_through = true;
+        switch (instr.op) {
+        case Opcode::fe:
+            ok = in_range(instr.id, frame.full_expr_infos.length());
+            break;
+        case Opcode::nop:
+        case Opcode::zero:
+        case Opcode::zeroi:
+            break;
+        case Opcode::dsg: {
+            InstrInfo::IdentifierId id{instr.id};
+            if (id.isFuntion()) {
+                ok = in_range(id.value(), bytecode.functions.length());
+                state.dsg_func = id.value();
+            } else {
+                ok = in_range(id.value(), id.isGlobal() ? bytecode.static_objects.length() : frame.max_object_num);
+                state.dsg_func = State::UNKNOWN;
+            }
+        }
+            break;
+        case Opcode::drf: {
+            auto referenced = state.top_func;
+            ok = apply(1, 0);
+            state.dsg_func = referenced;
+        }
+            break;
+        case Opcode::read:
+        case Opcode::addr: {
+            auto designated = state.dsg_func;
+            ok = apply(0, 1);
+            state.top_func = designated;
+        }
+            break;
+        case Opcode::mdf:
+        case Opcode::mdfi:
+        case Opcode::pop:
+        case Opcode::del:
+            ok = apply(1, 0);
+            break;
+        case Opcode::eb:
+            ok = in_range(instr.id, frame.blocks.length());
+            state.block_depth++;
+            break;
+        case Opcode::lb:
+            ok = state.block_depth > 0;
+            state.block_depth--;
+            break;
+        case Opcode::new_:
+            ok = in_range(instr.id, bytecode.types.length()) && apply(1, 1);
+            break;
+        case Opcode::cast:
+            ok = in_range(instr.id, bytecode.types.length()) && apply(1, 1);
+            break;
+        case Opcode::j:
+            ok = flow_to(next_pc + instr.offset, state);
+            fall_through = false;
+            break;
+        case Opcode::jst:
+        case Opcode::jnt:
+            ok = apply(1, 0) && flow_to(next_pc + instr.offset, state);
+            break;
+        case Opcode::call: {
+            if (state.top_func == State::UNKNOWN) {
+                return false;
+            }
+            auto& callee_type = functionType(bytecode.functions[state.top_func]);
+            ok = apply(1 + static_cast<int64_t>(callee_type.params.length()), returnValueCnt(callee_type));
+            state.dsg_func = State::UNKNOWN;
+        }
+            break;
+        case Opcode::ij:
+            return false;
+        case Opcode::ret:
+            ok = state.stack_depth == returnValueCnt(self_type);
+            fall_through = false;
+            break;
+        case Opcode::halt:
+            fall_through = false;
+            break;
+        case Opcode::pushu:
+            ok = apply(0, 1);
+            break;
+        case Opcode::push:
+            ok = in_range(instr.id, bytecode.constants.length()) && apply(0, 1);
+            break;
+        case Opcode::dup:
+            ok = state.stack_depth >= 1;
+            state.stack_depth++;
+            break;
+        case Opcode::dot:
+            state.dsg_func = State::UNKNOWN;
+            break;
+        case Opcode::arrow:
+            ok = apply(1, 0);
+            state.dsg_func = State::UNKNOWN;
+            break;
+        default:
+            if (FetchDecode::isUnaryOperator(instr.op)) {
+                ok = apply(1, 1);
+            } else if (FetchDecode::isBinaryOperator(instr.op)) {
+                ok = apply(2, 1);
+            } else {
+                return false;
+            }
+        }
+        if (!ok || (fall_through && !flow_to(next_pc, state))) {
+            return false;
+        }
+    }
+    return true;
+}